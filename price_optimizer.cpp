@@ -1,26 +1,240 @@
+#include "price_optimizer.h"
+
 #include <iostream>
 #include <vector>
 #include <cmath>
 #include <random>
 #include <algorithm>
 #include <numeric>
+#include <queue>
 #include <map>
+#include <mutex>
 #include <functional>
 #include <memory>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <utility>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <charconv>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <shared_mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <thread>
+#include <tuple>
+#include <fcntl.h>
+#include <linux/perf_event.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#ifndef PRICING_ENABLE_TRACING
+#define PRICING_ENABLE_TRACING 1
+#endif
+
+struct TraceEvent {
+    const char* name;
+    uint64_t start;
+    uint64_t end;
+};
+
+// Single-writer ring owned by one thread. Old spans are overwritten once the
+// ring wraps; readers take a snapshot of the most recent capacity() spans.
+class TraceRing {
+private:
+    std::unique_ptr<TraceEvent[]> events;
+    std::size_t mask;
+    std::atomic<uint64_t> head{0};
+    uint32_t thread_index;
+    
+public:
+    TraceRing(std::size_t capacity_pow2, uint32_t index)
+        : events(new TraceEvent[capacity_pow2]), mask(capacity_pow2 - 1), thread_index(index) {}
+    
+    void record(const char* name, uint64_t start, uint64_t end) {
+        uint64_t h = head.load(std::memory_order_relaxed);
+        events[h & mask] = {name, start, end};
+        head.store(h + 1, std::memory_order_release);
+    }
+    
+    std::vector<TraceEvent> snapshot() const {
+        uint64_t h = head.load(std::memory_order_acquire);
+        uint64_t first = h > mask + 1 ? h - (mask + 1) : 0;
+        std::vector<TraceEvent> out;
+        out.reserve(static_cast<std::size_t>(h - first));
+        for (uint64_t i = first; i < h; ++i) {
+            out.push_back(events[i & mask]);
+        }
+        return out;
+    }
+    
+    void reset() { head.store(0, std::memory_order_release); }
+    uint64_t recorded() const { return head.load(std::memory_order_acquire); }
+    std::size_t capacity() const { return mask + 1; }
+    uint32_t threadIndex() const { return thread_index; }
+};
+
+// Process-wide span recorder. Rings are registered once per thread and live
+// until exit so spans from finished workers can still be dumped.
+class TraceRecorder {
+private:
+    std::mutex registry_mutex;
+    std::vector<std::unique_ptr<TraceRing>> rings;
+    std::atomic<bool> enabled{false};
+    std::size_t ring_capacity = 1 << 16;
+    uint64_t origin_ticks = 0;
+    std::chrono::steady_clock::time_point origin_time;
+    
+    TraceRing* registerThread() {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        rings.push_back(std::make_unique<TraceRing>(ring_capacity, static_cast<uint32_t>(rings.size())));
+        return rings.back().get();
+    }
+    
+public:
+    static TraceRecorder& instance() {
+        static TraceRecorder recorder;
+        return recorder;
+    }
+    
+    static uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+    
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+    
+    // Capacity applies to rings registered after the call.
+    void start(std::size_t capacity = 1 << 16) {
+        std::size_t pow2 = 1;
+        while (pow2 < capacity) {
+            pow2 <<= 1;
+        }
+        ring_capacity = pow2;
+        origin_time = std::chrono::steady_clock::now();
+        origin_ticks = now();
+        enabled.store(true, std::memory_order_release);
+    }
+    
+    void stop() { enabled.store(false, std::memory_order_release); }
+    
+    void clear() {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        for (auto& ring : rings) {
+            ring->reset();
+        }
+    }
+    
+    TraceRing& localRing() {
+        thread_local TraceRing* ring = nullptr;
+        if (!ring) {
+            ring = registerThread();
+        }
+        return *ring;
+    }
+    
+    // Tick rate measured against steady_clock since start(); 1 when ticks are
+    // already nanoseconds.
+    double ticksPerNanosecond() const {
+#if defined(__x86_64__) || defined(__i386__)
+        auto elapsed = std::chrono::steady_clock::now() - origin_time;
+        if (elapsed < std::chrono::milliseconds(10)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10) - elapsed);
+        }
+        uint64_t ticks = now() - origin_ticks;
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - origin_time).count();
+        return ns > 0.0 ? ticks / ns : 1.0;
+#else
+        return 1.0;
+#endif
+    }
+    
+    uint64_t originTicks() const { return origin_ticks; }
+    
+    std::vector<const TraceRing*> threadRings() {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        std::vector<const TraceRing*> out;
+        for (auto& ring : rings) {
+            out.push_back(ring.get());
+        }
+        return out;
+    }
+};
+
+class TraceSpan {
+private:
+    const char* name;
+    uint64_t start;
+    
+public:
+    explicit TraceSpan(const char* span_name)
+        : name(span_name), start(TraceRecorder::instance().isEnabled() ? TraceRecorder::now() : 0) {}
+    
+    ~TraceSpan() {
+        if (start) {
+            TraceRecorder::instance().localRing().record(name, start, TraceRecorder::now());
+        }
+    }
+    
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+};
+
+#define PRICING_TRACE_CONCAT_INNER(a, b) a##b
+#define PRICING_TRACE_CONCAT(a, b) PRICING_TRACE_CONCAT_INNER(a, b)
+#if PRICING_ENABLE_TRACING
+#define PRICING_TRACE_SCOPE(name) TraceSpan PRICING_TRACE_CONCAT(trace_span_, __LINE__)(name)
+#else
+#define PRICING_TRACE_SCOPE(name) do {} while (0)
+#endif
 
 class GammaPoissonModel {
 private:
     double alpha;
     double beta;
+    double prior_alpha;
+    double prior_beta;
     std::mt19937 rng;
     
 public:
     GammaPoissonModel(double a = 2.0, double b = 1.0) 
-        : alpha(a), beta(b), rng(std::random_device{}()) {}
+        : alpha(a), beta(b), prior_alpha(a), prior_beta(b), rng(std::random_device{}()) {}
     
     void fit(const std::vector<int>& purchase_data, int iterations = 1000) {
-        int n = purchase_data.size();
-        double sum_purchases = std::accumulate(purchase_data.begin(), purchase_data.end(), 0.0);
+        fit(purchase_data.data(), purchase_data.size(), iterations);
+    }
+    
+    void fit(const int* purchase_data, std::size_t count, int iterations = 1000) {
+        fitParameters(purchase_data, count, iterations, alpha, beta);
+    }
+    
+    // The fixed-point iteration behind fit(), starting from alpha/beta. Needs
+    // no model instance, so batch fits skip seeding an RNG per product.
+    static void fitParameters(const int* purchase_data, std::size_t count, int iterations,
+                              double& alpha, double& beta) {
+        PRICING_TRACE_SCOPE("gamma_poisson_fit");
+        int n = static_cast<int>(count);
+        double sum_purchases = std::accumulate(purchase_data, purchase_data + count, 0.0);
         
         for (int i = 0; i < iterations; ++i) {
             alpha = (alpha + sum_purchases) / (1.0 + n / beta);
@@ -42,313 +256,6587 @@ public:
         return predictions;
     }
     
+    // Online conjugate update with one period's purchase count. forgetting
+    // below 1 decays the accumulated evidence toward the constructor's prior
+    // before adding the period, the same rule StreamingGammaPoissonStore uses.
+    void observe(int purchases, double forgetting = 1.0) {
+        alpha = prior_alpha + forgetting * (alpha - prior_alpha) + purchases;
+        beta = prior_beta + forgetting * (beta - prior_beta) + 1.0;
+    }
+    
     double getMean() const { return alpha / beta; }
     double getVariance() const { return alpha / (beta * beta); }
     double getAlpha() const { return alpha; }
     double getBeta() const { return beta; }
 };
 
-class ElasticityCalculator {
+struct LogRegressionAccumulator {
+    double sum_x = 0.0;
+    double sum_y = 0.0;
+    double sum_xy = 0.0;
+    double sum_xx = 0.0;
+    std::size_t count = 0;
+    
+    void add(double log_x, double log_y) {
+        sum_x += log_x;
+        sum_y += log_y;
+        sum_xy += log_x * log_y;
+        sum_xx += log_x * log_x;
+        ++count;
+    }
+    
+    double slope() const {
+        int n = static_cast<int>(count);
+        return (n * sum_xy - sum_x * sum_y) / (n * sum_xx - sum_x * sum_x);
+    }
+};
+
+// Per-product price/quantity histories packed for regression. Prices are
+// snapped to cents and dictionary-encoded; quantities are rounded to whole
+// units and frame-of-reference encoded. Both are bit-packed at the minimum
+// width for the product.
+class CompressedHistoryStore {
+public:
+    struct Fit {
+        double elasticity;
+        double base_demand;
+    };
+    
 private:
-    std::map<std::string, double> elasticity_coefficients;
-    std::map<std::string, double> base_demand;
+    struct Entry {
+        uint64_t bit_offset;
+        uint32_t dictionary_offset;
+        uint32_t count;
+        uint32_t quantity_base;
+        uint16_t dictionary_size;
+        uint8_t price_bits;
+        uint8_t quantity_bits;
+    };
     
-    double logRegression(const std::vector<double>& x, const std::vector<double>& y) {
-        std::vector<double> log_x, log_y;
-        for (size_t i = 0; i < x.size(); ++i) {
-            log_x.push_back(std::log(x[i] + 1e-10));
-            log_y.push_back(std::log(y[i] + 1e-10));
+    std::vector<Entry> entries;
+    std::vector<int32_t> price_dictionary;
+    std::vector<uint64_t> bits;
+    uint64_t bit_length = 0;
+    std::size_t observations = 0;
+    
+    static uint8_t bitWidth(uint64_t max_value) {
+        uint8_t width = 0;
+        while (width < 64 && (max_value >> width) != 0) {
+            ++width;
         }
-        
-        double sum_x = std::accumulate(log_x.begin(), log_x.end(), 0.0);
-        double sum_y = std::accumulate(log_y.begin(), log_y.end(), 0.0);
-        double sum_xy = 0.0, sum_xx = 0.0;
-        
-        for (size_t i = 0; i < log_x.size(); ++i) {
-            sum_xy += log_x[i] * log_y[i];
-            sum_xx += log_x[i] * log_x[i];
+        return width;
+    }
+    
+    void appendBits(uint64_t value, uint8_t width) {
+        if (width == 0) {
+            return;
         }
-        
-        int n = log_x.size();
-        return (n * sum_xy - sum_x * sum_y) / (n * sum_xx - sum_x * sum_x);
+        std::size_t word = bit_length >> 6;
+        unsigned shift = bit_length & 63;
+        if (word + 1 >= bits.size()) {
+            bits.resize(word + 2, 0);
+        }
+        bits[word] |= value << shift;
+        if (shift + width > 64) {
+            bits[word + 1] |= value >> (64 - shift);
+        }
+        bit_length += width;
+    }
+    
+    uint64_t readBits(uint64_t position, uint8_t width) const {
+        if (width == 0) {
+            return 0;
+        }
+        std::size_t word = position >> 6;
+        unsigned shift = position & 63;
+        uint64_t value = bits[word] >> shift;
+        if (shift + width > 64) {
+            value |= bits[word + 1] << (64 - shift);
+        }
+        return value & ((width == 64) ? ~0ULL : ((1ULL << width) - 1));
     }
     
 public:
-    double calculateElasticity(const std::vector<double>& prices, 
-                              const std::vector<double>& quantities,
-                              const std::string& product_id) {
-        double elasticity = logRegression(prices, quantities);
-        elasticity_coefficients[product_id] = elasticity;
+    uint32_t addProduct(const double* prices, const double* quantities, std::size_t n) {
+        Entry e{};
+        e.bit_offset = bit_length;
+        e.dictionary_offset = static_cast<uint32_t>(price_dictionary.size());
+        e.count = static_cast<uint32_t>(n);
         
-        double sum = std::accumulate(quantities.begin(), quantities.end(), 0.0);
-        base_demand[product_id] = sum / quantities.size();
+        std::vector<int32_t> cents(n);
+        std::vector<uint32_t> units(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            cents[i] = static_cast<int32_t>(std::llround(prices[i] * 100.0));
+            units[i] = static_cast<uint32_t>(std::max(0LL, std::llround(quantities[i])));
+        }
         
-        return elasticity;
+        std::vector<int32_t> dictionary(cents);
+        std::sort(dictionary.begin(), dictionary.end());
+        dictionary.erase(std::unique(dictionary.begin(), dictionary.end()), dictionary.end());
+        if (dictionary.size() > std::numeric_limits<uint16_t>::max()) {
+            throw std::length_error("price history has more than 65535 distinct prices");
+        }
+        e.dictionary_size = static_cast<uint16_t>(dictionary.size());
+        e.price_bits = dictionary.size() > 1 ? bitWidth(dictionary.size() - 1) : 0;
+        price_dictionary.insert(price_dictionary.end(), dictionary.begin(), dictionary.end());
+        
+        uint32_t min_units = n ? *std::min_element(units.begin(), units.end()) : 0;
+        uint32_t max_units = n ? *std::max_element(units.begin(), units.end()) : 0;
+        e.quantity_base = min_units;
+        e.quantity_bits = bitWidth(max_units - min_units);
+        
+        bits.reserve((bit_length + n * (e.price_bits + e.quantity_bits)) / 64 + 2);
+        for (std::size_t i = 0; i < n; ++i) {
+            auto slot = std::lower_bound(dictionary.begin(), dictionary.end(), cents[i]) - dictionary.begin();
+            appendBits(static_cast<uint64_t>(slot), e.price_bits);
+            appendBits(units[i] - min_units, e.quantity_bits);
+        }
+        
+        entries.push_back(e);
+        observations += n;
+        return static_cast<uint32_t>(entries.size() - 1);
     }
     
-    double predictDemand(double current_price, double new_price, 
-                        const std::string& product_id) const {
-        auto it = elasticity_coefficients.find(product_id);
-        if (it == elasticity_coefficients.end()) {
-            auto bd_it = base_demand.find(product_id);
-            return (bd_it != base_demand.end()) ? bd_it->second : 0.0;
+    template <typename Sink>
+    void decode(uint32_t product, Sink sink) const {
+        const Entry& e = entries[product];
+        const int32_t* dictionary = price_dictionary.data() + e.dictionary_offset;
+        uint64_t position = e.bit_offset;
+        for (uint32_t i = 0; i < e.count; ++i) {
+            uint64_t slot = readBits(position, e.price_bits);
+            position += e.price_bits;
+            uint64_t units = readBits(position, e.quantity_bits) + e.quantity_base;
+            position += e.quantity_bits;
+            sink(dictionary[slot] / 100.0, static_cast<double>(units));
+        }
+    }
+    
+    // Streams one product's history into regression accumulators; log prices
+    // are taken once per distinct price rather than once per observation.
+    Fit fit(uint32_t product) const {
+        const Entry& e = entries[product];
+        const int32_t* dictionary = price_dictionary.data() + e.dictionary_offset;
+        double log_prices_small[64];
+        std::vector<double> log_prices_large;
+        double* log_prices = log_prices_small;
+        if (e.dictionary_size > 64) {
+            log_prices_large.resize(e.dictionary_size);
+            log_prices = log_prices_large.data();
+        }
+        for (uint32_t i = 0; i < e.dictionary_size; ++i) {
+            log_prices[i] = std::log(dictionary[i] / 100.0 + 1e-10);
         }
         
-        double elasticity = it->second;
-        double price_ratio = new_price / current_price;
-        double demand_change = std::pow(price_ratio, elasticity);
+        LogRegressionAccumulator acc;
+        double sum_units = 0.0;
+        uint64_t position = e.bit_offset;
         
-        return base_demand.at(product_id) * demand_change;
+        std::size_t quantity_range = std::size_t(1) << e.quantity_bits;
+        if (e.quantity_bits <= 10 && quantity_range <= e.count) {
+            double log_units[1024];
+            for (std::size_t q = 0; q < quantity_range; ++q) {
+                log_units[q] = std::log(static_cast<double>(q + e.quantity_base) + 1e-10);
+            }
+            for (uint32_t i = 0; i < e.count; ++i) {
+                uint64_t slot = readBits(position, e.price_bits);
+                position += e.price_bits;
+                uint64_t offset = readBits(position, e.quantity_bits);
+                position += e.quantity_bits;
+                acc.add(log_prices[slot], log_units[offset]);
+                sum_units += static_cast<double>(offset + e.quantity_base);
+            }
+        } else {
+            for (uint32_t i = 0; i < e.count; ++i) {
+                uint64_t slot = readBits(position, e.price_bits);
+                position += e.price_bits;
+                double units = static_cast<double>(readBits(position, e.quantity_bits) + e.quantity_base);
+                position += e.quantity_bits;
+                acc.add(log_prices[slot], std::log(units + 1e-10));
+                sum_units += units;
+            }
+        }
+        return {acc.slope(), e.count ? sum_units / e.count : 0.0};
     }
     
-    double getElasticity(const std::string& product_id) const {
-        auto it = elasticity_coefficients.find(product_id);
-        return (it != elasticity_coefficients.end()) ? it->second : 0.0;
+    std::size_t size() const { return entries.size(); }
+    std::size_t observationCount() const { return observations; }
+    
+    std::size_t memoryUsage() const {
+        return entries.capacity() * sizeof(Entry) + price_dictionary.capacity() * sizeof(int32_t) +
+               bits.capacity() * sizeof(uint64_t);
+    }
+    
+    std::size_t uncompressedBytes() const { return observations * 2 * sizeof(double); }
+    
+    void shrinkToFit() {
+        entries.shrink_to_fit();
+        price_dictionary.shrink_to_fit();
+        bits.shrink_to_fit();
     }
 };
 
-struct OptimizationResult {
-    double optimal_price;
-    double expected_demand;
-    double expected_revenue;
-    double revenue_lift_percent;
+struct ElasticityEntry {
+    double elasticity = 0.0;
+    double base_demand = 0.0;
 };
 
-class PriceOptimizer {
+// Product id -> fitted demand model, split across independently locked hash
+// map shards. Writers to different shards never contend and readers take
+// only a shared lock on one shard.
+class ConcurrentElasticityStore {
 private:
-    ElasticityCalculator elasticity_calc;
+    static constexpr std::size_t kShards = 64;
     
-    double objectiveFunction(double price, double cost, double current_price,
-                            const std::string& product_id) const {
-        double demand = elasticity_calc.predictDemand(current_price, price, product_id);
-        return (price - cost) * demand;
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<std::string, ElasticityEntry> entries;
+    };
+    
+    std::unique_ptr<Shard[]> shards;
+    
+    Shard& shardFor(const std::string& product_id) const {
+        uint64_t h = std::hash<std::string>{}(product_id) * 0x9e3779b97f4a7c15ULL;
+        return shards[h >> 58];
     }
     
-    double goldenSectionSearch(double a, double b, double cost, 
-                              double current_price, const std::string& product_id,
-                              double tolerance = 1e-5) const {
-        const double phi = (1.0 + std::sqrt(5.0)) / 2.0;
-        const double resphi = 2.0 - phi;
-        
-        double x1 = a + resphi * (b - a);
-        double x2 = b - resphi * (b - a);
-        double f1 = -objectiveFunction(x1, cost, current_price, product_id);
-        double f2 = -objectiveFunction(x2, cost, current_price, product_id);
-        
-        while (std::abs(b - a) > tolerance) {
-            if (f1 < f2) {
-                b = x2;
-                x2 = x1;
-                f2 = f1;
-                x1 = a + resphi * (b - a);
-                f1 = -objectiveFunction(x1, cost, current_price, product_id);
-            } else {
-                a = x1;
-                x1 = x2;
-                f1 = f2;
-                x2 = b - resphi * (b - a);
-                f2 = -objectiveFunction(x2, cost, current_price, product_id);
+public:
+    ConcurrentElasticityStore() : shards(new Shard[kShards]) {}
+    
+    ConcurrentElasticityStore(const ConcurrentElasticityStore& other) : shards(new Shard[kShards]) {
+        for (std::size_t i = 0; i < kShards; ++i) {
+            std::shared_lock<std::shared_mutex> lock(other.shards[i].mutex);
+            shards[i].entries = other.shards[i].entries;
+        }
+    }
+    
+    ConcurrentElasticityStore& operator=(const ConcurrentElasticityStore& other) {
+        if (this != &other) {
+            for (std::size_t i = 0; i < kShards; ++i) {
+                std::shared_lock<std::shared_mutex> read_lock(other.shards[i].mutex);
+                std::unique_lock<std::shared_mutex> write_lock(shards[i].mutex);
+                shards[i].entries = other.shards[i].entries;
             }
         }
-        
-        return (a + b) / 2.0;
+        return *this;
     }
     
-public:
-    void trainElasticity(const std::string& product_id,
-                        const std::vector<double>& prices,
-                        const std::vector<double>& quantities) {
-        elasticity_calc.calculateElasticity(prices, quantities, product_id);
+    void store(const std::string& product_id, const ElasticityEntry& entry) {
+        Shard& shard = shardFor(product_id);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        shard.entries[product_id] = entry;
     }
     
-    OptimizationResult optimizePrice(const std::string& product_id,
-                                    double current_price,
-                                    double cost,
-                                    const std::vector<double>& competitor_prices,
-                                    int inventory_level,
-                                    int target_inventory) {
-        double min_comp = competitor_prices.empty() ? current_price * 0.8 :
-                         *std::min_element(competitor_prices.begin(), competitor_prices.end());
-        double max_comp = competitor_prices.empty() ? current_price * 1.2 :
-                         *std::max_element(competitor_prices.begin(), competitor_prices.end());
-        
-        double inventory_factor = 1.0;
-        if (inventory_level > target_inventory * 1.2) {
-            inventory_factor = 0.95;
-        } else if (inventory_level < target_inventory * 0.8) {
-            inventory_factor = 1.05;
+    bool find(const std::string& product_id, ElasticityEntry& entry) const {
+        const Shard& shard = shardFor(product_id);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.entries.find(product_id);
+        if (it == shard.entries.end()) {
+            return false;
         }
-        
-        double lower_bound = std::max(cost * 1.1, min_comp * 0.95 * inventory_factor);
-        double upper_bound = std::min(current_price * 1.5, max_comp * 1.05 * inventory_factor);
-        
-        double optimal_price = goldenSectionSearch(lower_bound, upper_bound, cost,
-                                                   current_price, product_id);
-        
-        double expected_demand = elasticity_calc.predictDemand(current_price, 
-                                                               optimal_price, product_id);
-        double expected_revenue = (optimal_price - cost) * expected_demand;
-        
-        double current_demand = elasticity_calc.predictDemand(current_price, 
-                                                              current_price, product_id);
-        double current_revenue = (current_price - cost) * current_demand;
-        double revenue_lift = ((expected_revenue - current_revenue) / current_revenue) * 100.0;
-        
-        return {optimal_price, expected_demand, expected_revenue, revenue_lift};
+        entry = it->second;
+        return true;
     }
     
-    double getElasticity(const std::string& product_id) const {
-        return elasticity_calc.getElasticity(product_id);
+    std::size_t size() const {
+        std::size_t n = 0;
+        for (std::size_t i = 0; i < kShards; ++i) {
+            std::shared_lock<std::shared_mutex> lock(shards[i].mutex);
+            n += shards[i].entries.size();
+        }
+        return n;
     }
 };
 
-class BayesianOptimizer {
+// Thread-safe: products can be trained in parallel while other threads read.
+class ElasticityCalculator {
 private:
-    struct Point {
-        std::vector<double> x;
-        double y;
-    };
-    
-    std::vector<Point> observations;
-    std::vector<std::pair<double, double>> bounds;
-    std::mt19937 rng;
+    ConcurrentElasticityStore models;
     
-    double expectedImprovement(const std::vector<double>& x, double best_y) {
-        double mu = 0.0;
-        double sigma = 1.0;
-        
-        for (const auto& obs : observations) {
-            double dist = 0.0;
-            for (size_t i = 0; i < x.size(); ++i) {
-                dist += (x[i] - obs.x[i]) * (x[i] - obs.x[i]);
-            }
-            dist = std::sqrt(dist);
-            
-            double kernel = std::exp(-0.5 * dist);
-            mu += kernel * obs.y;
-            sigma *= (1.0 - kernel * 0.1);
-        }
-        
-        if (!observations.empty()) {
-            mu /= observations.size();
-            sigma = std::max(sigma, 0.01);
-        }
-        
-        double z = (mu - best_y) / sigma;
-        double phi = 0.5 * (1.0 + std::erf(z / std::sqrt(2.0)));
-        double pdf = std::exp(-0.5 * z * z) / std::sqrt(2.0 * M_PI);
-        
-        return (mu - best_y) * phi + sigma * pdf;
+    double logRegression(const std::vector<double>& x, const std::vector<double>& y) {
+        return fitLogLogSlope(x.data(), y.data(), x.size());
     }
     
 public:
-    BayesianOptimizer(const std::vector<std::pair<double, double>>& b)
-        : bounds(b), rng(std::random_device{}()) {}
-    
-    std::vector<double> proposeNext() {
-        if (observations.size() < 5) {
-            std::vector<double> x;
-            for (const auto& bound : bounds) {
-                std::uniform_real_distribution<double> dist(bound.first, bound.second);
-                x.push_back(dist(rng));
-            }
-            return x;
-        }
-        
-        double best_y = observations.empty() ? 0.0 : 
-                       std::max_element(observations.begin(), observations.end(),
-                                      [](const Point& a, const Point& b) { 
-                                          return a.y < b.y; 
-                                      })->y;
-        
-        std::vector<double> best_x;
-        double best_ei = -std::numeric_limits<double>::infinity();
-        
-        for (int i = 0; i < 100; ++i) {
-            std::vector<double> x;
-            for (const auto& bound : bounds) {
-                std::uniform_real_distribution<double> dist(bound.first, bound.second);
-                x.push_back(dist(rng));
-            }
-            
-            double ei = expectedImprovement(x, best_y);
-            if (ei > best_ei) {
-                best_ei = ei;
-                best_x = x;
-            }
+    static double fitLogLogSlope(const double* x, const double* y, std::size_t count) {
+        PRICING_TRACE_SCOPE("log_regression");
+        LogRegressionAccumulator acc;
+        for (std::size_t i = 0; i < count; ++i) {
+            acc.add(std::log(x[i] + 1e-10), std::log(y[i] + 1e-10));
         }
+        return acc.slope();
+    }
+    
+    double calculateElasticity(const std::vector<double>& prices, 
+                              const std::vector<double>& quantities,
+                              const std::string& product_id) {
+        PRICING_TRACE_SCOPE("elasticity_fit");
+        double elasticity = logRegression(prices, quantities);
+        double sum = std::accumulate(quantities.begin(), quantities.end(), 0.0);
+        models.store(product_id, {elasticity, sum / quantities.size()});
         
-        return best_x;
+        return elasticity;
     }
     
-    void update(const std::vector<double>& x, double y) {
-        observations.push_back({x, y});
+    double calculateElasticity(const CompressedHistoryStore& histories, uint32_t history,
+                               const std::string& product_id) {
+        PRICING_TRACE_SCOPE("elasticity_fit");
+        CompressedHistoryStore::Fit fit = histories.fit(history);
+        models.store(product_id, {fit.elasticity, fit.base_demand});
+        return fit.elasticity;
     }
     
-    std::pair<std::vector<double>, double> getBest() const {
-        if (observations.empty()) {
-            return {{}, 0.0};
+    // Untrained products get a zero model (no demand).
+    ElasticityEntry getModel(const std::string& product_id) const {
+        ElasticityEntry entry;
+        models.find(product_id, entry);
+        return entry;
+    }
+    
+    double predictDemand(double current_price, double new_price, 
+                        const std::string& product_id) const {
+        ElasticityEntry entry;
+        if (!models.find(product_id, entry)) {
+            return 0.0;
         }
         
-        auto best = std::max_element(observations.begin(), observations.end(),
-                                    [](const Point& a, const Point& b) { 
-                                        return a.y < b.y; 
-                                    });
-        return {best->x, best->y};
+        double price_ratio = new_price / current_price;
+        double demand_change = std::pow(price_ratio, entry.elasticity);
+        
+        return entry.base_demand * demand_change;
     }
+    
+    double getElasticity(const std::string& product_id) const { return getModel(product_id).elasticity; }
+    double getBaseDemand(const std::string& product_id) const { return getModel(product_id).base_demand; }
+    std::size_t size() const { return models.size(); }
 };
 
-int main() {
+struct ProductModelRecord {
+    float elasticity;
+    float base_demand;
+    float alpha;
+    float beta;
+    float reference_price;
+    uint32_t version;
+};
+
+static_assert(sizeof(ProductModelRecord) <= 32, "ProductModelRecord must stay within 32 bytes");
+
+// Dense, index-addressed model state for very large catalogs. Callers own the
+// product_id -> index mapping so no string keys are stored per product.
+class ProductModelTable {
+private:
+    std::vector<ProductModelRecord> records;
+    
+public:
+    explicit ProductModelTable(std::size_t capacity = 0) {
+        records.reserve(capacity);
+    }
+    
+    uint32_t addProduct(double reference_price) {
+        records.push_back({0.0f, 0.0f, 2.0f, 1.0f, static_cast<float>(reference_price), 0});
+        return static_cast<uint32_t>(records.size() - 1);
+    }
+    
+    void resize(std::size_t n) {
+        records.resize(n, {0.0f, 0.0f, 2.0f, 1.0f, 0.0f, 0});
+    }
+    
+    void setElasticity(uint32_t index, double elasticity, double base_demand) {
+        ProductModelRecord& r = records[index];
+        r.elasticity = static_cast<float>(elasticity);
+        r.base_demand = static_cast<float>(base_demand);
+        ++r.version;
+    }
+    
+    void setDemandModel(uint32_t index, const GammaPoissonModel& model) {
+        ProductModelRecord& r = records[index];
+        r.alpha = static_cast<float>(model.getAlpha());
+        r.beta = static_cast<float>(model.getBeta());
+        ++r.version;
+    }
+    
+    void setReferencePrice(uint32_t index, double price) {
+        records[index].reference_price = static_cast<float>(price);
+        ++records[index].version;
+    }
+    
+    void assign(uint32_t index, const ElasticityCalculator& calc, const std::string& product_id,
+                const GammaPoissonModel& model) {
+        ProductModelRecord& r = records[index];
+        r.elasticity = static_cast<float>(calc.getElasticity(product_id));
+        r.base_demand = static_cast<float>(calc.getBaseDemand(product_id));
+        r.alpha = static_cast<float>(model.getAlpha());
+        r.beta = static_cast<float>(model.getBeta());
+        ++r.version;
+    }
+    
+    GammaPoissonModel demandModel(uint32_t index) const {
+        return GammaPoissonModel(records[index].alpha, records[index].beta);
+    }
+    
+    double predictDemand(uint32_t index, double new_price) const {
+        const ProductModelRecord& r = records[index];
+        if (r.reference_price <= 0.0f) {
+            return r.base_demand;
+        }
+        return r.base_demand * std::pow(new_price / r.reference_price, static_cast<double>(r.elasticity));
+    }
+    
+    const ProductModelRecord& operator[](uint32_t index) const { return records[index]; }
+    const ProductModelRecord* data() const { return records.data(); }
+    std::size_t size() const { return records.size(); }
+    
+    std::size_t memoryUsage() const {
+        return sizeof(*this) + records.capacity() * sizeof(ProductModelRecord);
+    }
+    
+    void shrinkToFit() { records.shrink_to_fit(); }
+    
+    static constexpr std::size_t bytesPerProduct() { return sizeof(ProductModelRecord); }
+    
+    static std::size_t memoryRequired(std::size_t products) {
+        return sizeof(ProductModelTable) + products * sizeof(ProductModelRecord);
+    }
+};
+
+struct OptimizationResult {
+    double optimal_price;
+    double expected_demand;
+    double expected_revenue;
+    double revenue_lift_percent;
+    int objective_evaluations = 0;
+    double price_tolerance = 0.0;
+    bool deadline_expired = false;
+};
+
+enum class LineSearchMethod {
+    Brent,
+    GoldenSection
+};
+
+// Brent stops once x is within about 2 * max(relative * |x|, absolute) of
+// the optimum; the defaults keep the returned price within half a cent.
+struct SearchSettings {
+    LineSearchMethod method = LineSearchMethod::Brent;
+    double relative_tolerance = 1e-5;
+    double absolute_tolerance = 0.0025;
+    int max_evaluations = 60;
+    double warm_start_width = 0.02;
+    double golden_section_tolerance = 1e-5;
+};
+
+// Tunable knobs of the pricing rule. Inventory above overstock_threshold x
+// target scales the bracket by overstock_factor (below understock_threshold,
+// by understock_factor). The bracket is
+//   [max(cost * cost_markup, min_comp * competitor_floor * f),
+//    min(current * current_price_cap, max_comp * competitor_ceiling * f)].
+struct PricingPolicy {
+    double overstock_threshold = 1.2;
+    double understock_threshold = 0.8;
+    double overstock_factor = 0.95;
+    double understock_factor = 1.05;
+    double cost_markup = 1.1;
+    double competitor_floor = 0.95;
+    double current_price_cap = 1.5;
+    double competitor_ceiling = 1.05;
+    SearchSettings search;
+    
+    double inventoryFactor(int inventory_level, int target_inventory) const {
+        if (inventory_level > target_inventory * overstock_threshold) {
+            return overstock_factor;
+        }
+        if (inventory_level < target_inventory * understock_threshold) {
+            return understock_factor;
+        }
+        return 1.0;
+    }
+    
+    std::pair<double, double> bracket(double current_price, double cost, double min_comp, double max_comp,
+                                      int inventory_level, int target_inventory) const {
+        double f = inventoryFactor(inventory_level, target_inventory);
+        return {std::max(cost * cost_markup, min_comp * competitor_floor * f),
+                std::min(current_price * current_price_cap, max_comp * competitor_ceiling * f)};
+    }
+};
+
+// A product's previous optimum; the next search starts from a bracket of
+// +/- half_width around it and widens only if the optimum hits its edge.
+struct WarmStartState {
+    double optimum = 0.0;
+    double half_width = 0.0;
+    bool valid = false;
+};
+
+struct LineSearchResult {
+    double x;
+    double fx;
+    int evaluations;
+    int iterations;
+    double bracket_width;
+    bool converged;
+    bool deadline_expired = false;
+};
+
+// Wall-clock budget for anytime searches. The clock is read only every
+// check_interval polls and expiry is sticky, so polling once per objective
+// evaluation stays cheap; use an interval of 1 when each poll guards a large
+// unit of work. A default-constructed deadline never expires.
+class SearchDeadline {
+private:
+    std::chrono::steady_clock::time_point deadline;
+    int check_interval = kDefaultCheckInterval;
+    int countdown = 0;
+    bool bounded = false;
+    bool expired_flag = false;
+    
+public:
+    static constexpr int kDefaultCheckInterval = 4;
+    
+    SearchDeadline() = default;
+    explicit SearchDeadline(std::chrono::steady_clock::time_point at, int interval = kDefaultCheckInterval)
+        : deadline(at), check_interval(std::max(1, interval)), bounded(true) {}
+    
+    static SearchDeadline after(std::chrono::nanoseconds budget, int interval = kDefaultCheckInterval) {
+        return SearchDeadline(std::chrono::steady_clock::now() + budget, interval);
+    }
+    
+    // Same deadline and expiry state, polled at a different interval.
+    SearchDeadline withCheckInterval(int interval) const {
+        SearchDeadline copy = *this;
+        copy.check_interval = std::max(1, interval);
+        copy.countdown = 0;
+        return copy;
+    }
+    
+    bool expired() {
+        if (!bounded || expired_flag) {
+            return expired_flag;
+        }
+        if (--countdown > 0) {
+            return false;
+        }
+        countdown = check_interval;
+        expired_flag = std::chrono::steady_clock::now() >= deadline;
+        return expired_flag;
+    }
+    
+    bool isBounded() const { return bounded; }
+    int checkInterval() const { return check_interval; }
+    std::chrono::steady_clock::time_point time() const { return deadline; }
+};
+
+// Streaming JSON serializer backed by one reusable buffer. Numbers are
+// formatted with std::to_chars (shortest round-trip) and nothing is allocated
+// per field once the buffer has reached its working size.
+class JsonWriter {
+private:
+    static constexpr int kMaxDepth = 32;
+    
+    std::string buffer;
+    std::ostream* sink;
+    std::size_t flush_threshold;
+    std::array<bool, kMaxDepth> has_members{};
+    int depth = 0;
+    bool after_key = false;
+    
+    void separator() {
+        if (after_key) {
+            after_key = false;
+            return;
+        }
+        if (depth > 0) {
+            if (has_members[depth - 1]) {
+                buffer.push_back(',');
+            }
+            has_members[depth - 1] = true;
+        }
+    }
+    
+    void open(char c) {
+        if (depth >= kMaxDepth) {
+            throw std::length_error("JSON nesting exceeds " + std::to_string(kMaxDepth) + " levels");
+        }
+        separator();
+        buffer.push_back(c);
+        has_members[depth] = false;
+        ++depth;
+    }
+    
+    void close(char c) {
+        if (depth == 0) {
+            throw std::logic_error("JSON close without matching open");
+        }
+        --depth;
+        buffer.push_back(c);
+        if (depth == 0 && sink && buffer.size() >= flush_threshold) {
+            flush();
+        }
+    }
+    
+    void appendEscaped(std::string_view text) {
+        static const char* hex = "0123456789abcdef";
+        buffer.push_back('"');
+        for (char c : text) {
+            switch (c) {
+                case '"': buffer.append("\\\""); break;
+                case '\\': buffer.append("\\\\"); break;
+                case '\n': buffer.append("\\n"); break;
+                case '\r': buffer.append("\\r"); break;
+                case '\t': buffer.append("\\t"); break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        char esc[6] = {'\\', 'u', '0', '0', hex[(c >> 4) & 0xf], hex[c & 0xf]};
+                        buffer.append(esc, sizeof(esc));
+                    } else {
+                        buffer.push_back(c);
+                    }
+            }
+        }
+        buffer.push_back('"');
+    }
+    
+public:
+    explicit JsonWriter(std::ostream* out = nullptr, std::size_t threshold = 1 << 16)
+        : sink(out), flush_threshold(threshold) {
+        buffer.reserve(threshold + 4096);
+    }
+    
+    ~JsonWriter() {
+        if (sink) {
+            flush();
+        }
+    }
+    
+    JsonWriter& beginObject() { open('{'); return *this; }
+    JsonWriter& endObject() { close('}'); return *this; }
+    JsonWriter& beginArray() { open('['); return *this; }
+    JsonWriter& endArray() { close(']'); return *this; }
+    
+    JsonWriter& key(std::string_view name) {
+        separator();
+        appendEscaped(name);
+        buffer.push_back(':');
+        after_key = true;
+        return *this;
+    }
+    
+    JsonWriter& value(double v) {
+        separator();
+        if (!std::isfinite(v)) {
+            buffer.append("null");
+            return *this;
+        }
+        char digits[32];
+        auto res = std::to_chars(digits, digits + sizeof(digits), v);
+        buffer.append(digits, res.ptr);
+        return *this;
+    }
+    
+    JsonWriter& value(int64_t v) {
+        separator();
+        char digits[24];
+        auto res = std::to_chars(digits, digits + sizeof(digits), v);
+        buffer.append(digits, res.ptr);
+        return *this;
+    }
+    
+    JsonWriter& value(int v) { return value(static_cast<int64_t>(v)); }
+    JsonWriter& value(uint64_t v) {
+        separator();
+        char digits[24];
+        auto res = std::to_chars(digits, digits + sizeof(digits), v);
+        buffer.append(digits, res.ptr);
+        return *this;
+    }
+    
+    JsonWriter& value(bool v) {
+        separator();
+        buffer.append(v ? "true" : "false");
+        return *this;
+    }
+    
+    JsonWriter& value(std::string_view v) {
+        separator();
+        appendEscaped(v);
+        return *this;
+    }
+    
+    JsonWriter& value(const char* v) { return value(std::string_view(v)); }
+    
+    template <typename T>
+    JsonWriter& field(std::string_view name, T v) {
+        return key(name).value(v);
+    }
+    
+    JsonWriter& writeResult(std::string_view product_id, const OptimizationResult& r) {
+        beginObject();
+        field("product_id", product_id);
+        field("optimal_price", r.optimal_price);
+        field("expected_demand", r.expected_demand);
+        field("expected_revenue", r.expected_revenue);
+        field("revenue_lift_percent", r.revenue_lift_percent);
+        field("objective_evaluations", r.objective_evaluations);
+        return endObject();
+    }
+    
+    JsonWriter& writeElasticity(std::string_view product_id, double elasticity, double base_demand) {
+        beginObject();
+        field("product_id", product_id);
+        field("elasticity", elasticity);
+        field("base_demand", base_demand);
+        return endObject();
+    }
+    
+    JsonWriter& writeGammaPoisson(std::string_view product_id, const GammaPoissonModel& model) {
+        beginObject();
+        field("product_id", product_id);
+        field("alpha", model.getAlpha());
+        field("beta", model.getBeta());
+        field("mean", model.getMean());
+        field("variance", model.getVariance());
+        return endObject();
+    }
+    
+    JsonWriter& newline() {
+        buffer.push_back('\n');
+        if (depth == 0 && sink && buffer.size() >= flush_threshold) {
+            flush();
+        }
+        return *this;
+    }
+    
+    void flush() {
+        if (sink && !buffer.empty()) {
+            sink->write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+    }
+    
+    const std::string& str() const { return buffer; }
+    
+    void clear() {
+        buffer.clear();
+        depth = 0;
+        after_key = false;
+    }
+};
+
+// Chrome/Perfetto trace-event JSON ("X" complete events, microsecond
+// timestamps relative to TraceRecorder::start()).
+void writeChromeTrace(JsonWriter& json, TraceRecorder& recorder) {
+    double ticks_per_us = recorder.ticksPerNanosecond() * 1000.0;
+    uint64_t origin = recorder.originTicks();
+    
+    json.beginObject();
+    json.key("traceEvents").beginArray();
+    for (const TraceRing* ring : recorder.threadRings()) {
+        int64_t tid = ring->threadIndex();
+        json.beginObject();
+        json.field("name", "thread_name");
+        json.field("ph", "M");
+        json.field("pid", 1);
+        json.field("tid", tid);
+        json.key("args").beginObject();
+        json.field("name", "pricing-" + std::to_string(tid));
+        json.endObject();
+        json.endObject();
+        
+        for (const TraceEvent& e : ring->snapshot()) {
+            if (e.start < origin) {
+                continue;
+            }
+            json.beginObject();
+            json.field("name", e.name);
+            json.field("cat", "pricing");
+            json.field("ph", "X");
+            json.field("ts", (e.start - origin) / ticks_per_us);
+            json.field("dur", (e.end - e.start) / ticks_per_us);
+            json.field("pid", 1);
+            json.field("tid", tid);
+            json.endObject();
+        }
+    }
+    json.endArray();
+    json.field("displayTimeUnit", "ns");
+    json.endObject();
+}
+
+// Minimal JSON DOM for reading back files this program wrote (baselines,
+// configs). Numbers are doubles; object members keep file order.
+struct JsonValue {
+    enum Type { Null, Bool, Number, String, Array, Object };
+    
+    Type type = Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string text;
+    std::vector<JsonValue> items;
+    std::vector<std::pair<std::string, JsonValue>> members;
+    
+    const JsonValue* find(std::string_view name) const {
+        for (const auto& m : members) {
+            if (m.first == name) {
+                return &m.second;
+            }
+        }
+        return nullptr;
+    }
+};
+
+class JsonReader {
+private:
+    std::string_view input;
+    std::size_t pos = 0;
+    
+    [[noreturn]] void fail(const char* what) const {
+        throw std::runtime_error(std::string("JSON parse error at offset ") + std::to_string(pos) + ": " + what);
+    }
+    
+    void skipSpace() {
+        while (pos < input.size() && (input[pos] == ' ' || input[pos] == '\n' ||
+                                      input[pos] == '\r' || input[pos] == '\t')) {
+            ++pos;
+        }
+    }
+    
+    void expect(char c) {
+        skipSpace();
+        if (pos >= input.size() || input[pos] != c) {
+            fail("unexpected character");
+        }
+        ++pos;
+    }
+    
+    bool consumeSeparator() {
+        skipSpace();
+        if (pos < input.size() && input[pos] == ',') {
+            ++pos;
+            return true;
+        }
+        return false;
+    }
+    
+    bool consumeLiteral(std::string_view literal) {
+        if (input.substr(pos, literal.size()) == literal) {
+            pos += literal.size();
+            return true;
+        }
+        return false;
+    }
+    
+    std::string parseString() {
+        expect('"');
+        std::string out;
+        while (pos < input.size() && input[pos] != '"') {
+            char c = input[pos++];
+            if (c != '\\') {
+                out.push_back(c);
+                continue;
+            }
+            if (pos >= input.size()) {
+                fail("truncated escape");
+            }
+            char e = input[pos++];
+            switch (e) {
+                case 'n': out.push_back('\n'); break;
+                case 'r': out.push_back('\r'); break;
+                case 't': out.push_back('\t'); break;
+                case 'b': out.push_back('\b'); break;
+                case 'f': out.push_back('\f'); break;
+                case 'u': {
+                    if (pos + 4 > input.size()) {
+                        fail("truncated unicode escape");
+                    }
+                    unsigned code = 0;
+                    auto res = std::from_chars(input.data() + pos, input.data() + pos + 4, code, 16);
+                    if (res.ptr != input.data() + pos + 4) {
+                        fail("bad unicode escape");
+                    }
+                    pos += 4;
+                    if (code < 0x80) {
+                        out.push_back(static_cast<char>(code));
+                    } else if (code < 0x800) {
+                        out.push_back(static_cast<char>(0xc0 | (code >> 6)));
+                        out.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+                    } else {
+                        out.push_back(static_cast<char>(0xe0 | (code >> 12)));
+                        out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+                        out.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+                    }
+                    break;
+                }
+                default: out.push_back(e);
+            }
+        }
+        if (pos >= input.size()) {
+            fail("unterminated string");
+        }
+        ++pos;
+        return out;
+    }
+    
+    JsonValue parseValue(int depth) {
+        if (depth > 64) {
+            fail("nesting too deep");
+        }
+        skipSpace();
+        if (pos >= input.size()) {
+            fail("unexpected end of input");
+        }
+        JsonValue v;
+        char c = input[pos];
+        if (c == '{') {
+            v.type = JsonValue::Object;
+            ++pos;
+            skipSpace();
+            if (pos < input.size() && input[pos] == '}') {
+                ++pos;
+                return v;
+            }
+            for (;;) {
+                std::string name = parseString();
+                expect(':');
+                v.members.emplace_back(std::move(name), parseValue(depth + 1));
+                if (!consumeSeparator()) {
+                    break;
+                }
+            }
+            expect('}');
+        } else if (c == '[') {
+            v.type = JsonValue::Array;
+            ++pos;
+            skipSpace();
+            if (pos < input.size() && input[pos] == ']') {
+                ++pos;
+                return v;
+            }
+            for (;;) {
+                v.items.push_back(parseValue(depth + 1));
+                if (!consumeSeparator()) {
+                    break;
+                }
+            }
+            expect(']');
+        } else if (c == '"') {
+            v.type = JsonValue::String;
+            v.text = parseString();
+        } else if (consumeLiteral("true")) {
+            v.type = JsonValue::Bool;
+            v.boolean = true;
+        } else if (consumeLiteral("false")) {
+            v.type = JsonValue::Bool;
+        } else if (consumeLiteral("null")) {
+            v.type = JsonValue::Null;
+        } else {
+            v.type = JsonValue::Number;
+            auto res = std::from_chars(input.data() + pos, input.data() + input.size(), v.number);
+            if (res.ec != std::errc()) {
+                fail("bad number");
+            }
+            pos = static_cast<std::size_t>(res.ptr - input.data());
+        }
+        return v;
+    }
+    
+public:
+    static JsonValue parse(std::string_view text) {
+        JsonReader reader;
+        reader.input = text;
+        JsonValue v = reader.parseValue(0);
+        reader.skipSpace();
+        if (reader.pos != text.size()) {
+            reader.fail("trailing characters");
+        }
+        return v;
+    }
+};
+
+class PriceOptimizer {
+private:
+    ElasticityCalculator elasticity_calc;
+    PricingPolicy policy;
+    std::unordered_map<std::string, WarmStartState> warm_starts;
+    bool warm_start_enabled = false;
+    
+    template <typename Objective>
+    LineSearchResult goldenSectionSearch(double a, double b, Objective objective, double tolerance,
+                                         int max_evaluations, SearchDeadline* deadline) const {
+        const double phi = (1.0 + std::sqrt(5.0)) / 2.0;
+        const double resphi = 2.0 - phi;
+        
+        double x1 = a + resphi * (b - a);
+        double x2 = b - resphi * (b - a);
+        double f1 = -objective(x1);
+        double f2 = -objective(x2);
+        int evaluations = 2;
+        int iterations = 0;
+        bool expired = false;
+        
+        while (std::abs(b - a) > tolerance && evaluations < max_evaluations) {
+            if (deadline && deadline->expired()) {
+                expired = true;
+                break;
+            }
+            if (f1 < f2) {
+                b = x2;
+                x2 = x1;
+                f2 = f1;
+                x1 = a + resphi * (b - a);
+                f1 = -objective(x1);
+            } else {
+                a = x1;
+                x1 = x2;
+                f1 = f2;
+                x2 = b - resphi * (b - a);
+                f2 = -objective(x2);
+            }
+            ++evaluations;
+            ++iterations;
+        }
+        
+        if (expired) {
+            // Cut short: report the better interior point with its own value.
+            double x = f1 < f2 ? x1 : x2;
+            return {x, -std::min(f1, f2), evaluations, iterations, std::abs(b - a), false, true};
+        }
+        double x = (a + b) / 2.0;
+        return {x, std::max(-f1, -f2), evaluations, iterations, std::abs(b - a),
+                std::abs(b - a) <= tolerance, false};
+    }
+    
+    // Brent's method: parabolic interpolation through the three best points,
+    // falling back to a golden-section step whenever the parabola is not
+    // trustworthy. Maximizes objective on [a, b].
+    template <typename Objective>
+    LineSearchResult brentSearch(double a, double b, Objective objective, int max_evaluations,
+                                 SearchDeadline* deadline) const {
+        const double golden = 0.3819660112501051;
+        if (a > b) {
+            std::swap(a, b);
+        }
+        
+        double x = a + golden * (b - a);
+        double w = x, v = x;
+        double fx = -objective(x);
+        double fw = fx, fv = fx;
+        double d = 0.0, e = 0.0;
+        int evaluations = 1;
+        int iterations = 0;
+        bool converged = false;
+        bool expired = false;
+        
+        while (evaluations < max_evaluations) {
+            double xm = 0.5 * (a + b);
+            double tol1 = std::max(policy.search.relative_tolerance * std::abs(x),
+                                   policy.search.absolute_tolerance);
+            double tol2 = 2.0 * tol1;
+            if (std::abs(x - xm) <= tol2 - 0.5 * (b - a)) {
+                converged = true;
+                break;
+            }
+            if (deadline && deadline->expired()) {
+                expired = true;
+                break;
+            }
+            ++iterations;
+            
+            bool parabolic = false;
+            if (std::abs(e) > tol1) {
+                double r = (x - w) * (fx - fv);
+                double q = (x - v) * (fx - fw);
+                double p = (x - v) * q - (x - w) * r;
+                q = 2.0 * (q - r);
+                if (q > 0.0) {
+                    p = -p;
+                }
+                q = std::abs(q);
+                double e_prev = e;
+                e = d;
+                if (std::abs(p) < std::abs(0.5 * q * e_prev) && p > q * (a - x) && p < q * (b - x)) {
+                    d = p / q;
+                    double u = x + d;
+                    if (u - a < tol2 || b - u < tol2) {
+                        d = std::copysign(tol1, xm - x);
+                    }
+                    parabolic = true;
+                }
+            }
+            if (!parabolic) {
+                e = (x >= xm) ? a - x : b - x;
+                d = golden * e;
+            }
+            
+            double u = (std::abs(d) >= tol1) ? x + d : x + std::copysign(tol1, d);
+            double fu = -objective(u);
+            ++evaluations;
+            
+            if (fu <= fx) {
+                if (u >= x) {
+                    a = x;
+                } else {
+                    b = x;
+                }
+                v = w; fv = fw;
+                w = x; fw = fx;
+                x = u; fx = fu;
+            } else {
+                if (u < x) {
+                    a = u;
+                } else {
+                    b = u;
+                }
+                if (fu <= fw || w == x) {
+                    v = w; fv = fw;
+                    w = u; fw = fu;
+                } else if (fu <= fv || v == x || v == w) {
+                    v = u; fv = fu;
+                }
+            }
+        }
+        
+        return {x, -fx, evaluations, iterations, b - a, converged, expired};
+    }
+    
+    template <typename Objective>
+    LineSearchResult lineSearch(double a, double b, Objective objective, int max_evaluations,
+                                SearchDeadline* deadline) const {
+        if (policy.search.method == LineSearchMethod::GoldenSection) {
+            return goldenSectionSearch(a, b, objective, policy.search.golden_section_tolerance, max_evaluations,
+                                       deadline);
+        }
+        return brentSearch(a, b, objective, max_evaluations, deadline);
+    }
+    
+    // Widening passes share one max_evaluations budget. A pass that ends at
+    // a bracket edge without budget left for another reports the full
+    // bracket width, like a deadline cut.
+    
+    template <typename Objective>
+    LineSearchResult warmLineSearch(double lower, double upper, Objective objective,
+                                    WarmStartState* warm, SearchDeadline* deadline) const {
+        const int budget = policy.search.max_evaluations;
+        if (!warm || !warm->valid || !(lower < upper)) {
+            LineSearchResult result = lineSearch(lower, upper, objective, budget, deadline);
+            rememberOptimum(warm, result.x);
+            return result;
+        }
+        
+        double half_width = warm->half_width;
+        int evaluations = 0;
+        for (;;) {
+            double a = std::max(lower, warm->optimum - half_width);
+            double b = std::min(upper, warm->optimum + half_width);
+            if (!(a < b)) {
+                a = lower;
+                b = upper;
+            }
+            
+            LineSearchResult result = lineSearch(a, b, objective, budget - evaluations, deadline);
+            evaluations += result.evaluations;
+            bool exhausted = budget - evaluations < 3;
+            double margin = 2.0 * std::max(policy.search.relative_tolerance * std::abs(result.x),
+                                           policy.search.absolute_tolerance);
+            bool at_low_edge = a > lower && result.x - a <= margin;
+            bool at_high_edge = b < upper && b - result.x <= margin;
+            if ((!at_low_edge && !at_high_edge) || result.deadline_expired || exhausted) {
+                if (at_low_edge || at_high_edge) {
+                    result.bracket_width = upper - lower;
+                }
+                result.evaluations = evaluations;
+                rememberOptimum(warm, result.x);
+                return result;
+            }
+            half_width *= 4.0;
+        }
+    }
+    
+    void rememberOptimum(WarmStartState* warm, double x) const {
+        if (!warm) {
+            return;
+        }
+        warm->optimum = x;
+        warm->half_width = std::max(policy.search.warm_start_width * std::abs(x),
+                                    4.0 * policy.search.absolute_tolerance);
+        warm->valid = true;
+    }
+    
+public:
+    void trainElasticity(const std::string& product_id,
+                        const std::vector<double>& prices,
+                        const std::vector<double>& quantities) {
+        elasticity_calc.calculateElasticity(prices, quantities, product_id);
+    }
+    
+    // Core optimization on an arbitrary demand curve; demand(price) returns
+    // expected units at that price. With a deadline the search stops early
+    // and returns its best price so far; price_tolerance is the width of the
+    // bracket still containing the optimum.
+    template <typename Demand>
+    OptimizationResult optimizeWithDemand(Demand demand,
+                                          double current_price,
+                                          double cost,
+                                          double min_comp,
+                                          double max_comp,
+                                          int inventory_level,
+                                          int target_inventory,
+                                          WarmStartState* warm = nullptr,
+                                          SearchDeadline* deadline = nullptr) const {
+        PRICING_TRACE_SCOPE("optimize");
+        double lower_bound, upper_bound;
+        {
+            PRICING_TRACE_SCOPE("bracket");
+            std::tie(lower_bound, upper_bound) = policy.bracket(current_price, cost, min_comp, max_comp,
+                                                                inventory_level, target_inventory);
+        }
+        
+        LineSearchResult search_result{};
+        {
+            PRICING_TRACE_SCOPE("search");
+            search_result = warmLineSearch(lower_bound, upper_bound, [&](double price) {
+                return (price - cost) * demand(price);
+            }, warm, deadline);
+        }
+        double optimal_price = search_result.x;
+        
+        PRICING_TRACE_SCOPE("result_assembly");
+        double expected_demand = demand(optimal_price);
+        double expected_revenue = (optimal_price - cost) * expected_demand;
+        
+        double current_demand = demand(current_price);
+        double current_revenue = (current_price - cost) * current_demand;
+        double revenue_lift = ((expected_revenue - current_revenue) / current_revenue) * 100.0;
+        
+        return {optimal_price, expected_demand, expected_revenue, revenue_lift, search_result.evaluations,
+                search_result.bracket_width, search_result.deadline_expired};
+    }
+    
+    OptimizationResult optimizePrice(const std::string& product_id,
+                                    double current_price,
+                                    double cost,
+                                    const std::vector<double>& competitor_prices,
+                                    int inventory_level,
+                                    int target_inventory) {
+        double min_comp = competitor_prices.empty() ? current_price * 0.8 :
+                         *std::min_element(competitor_prices.begin(), competitor_prices.end());
+        double max_comp = competitor_prices.empty() ? current_price * 1.2 :
+                         *std::max_element(competitor_prices.begin(), competitor_prices.end());
+        
+        // One store lookup per call rather than one per objective evaluation.
+        ElasticityEntry model = elasticity_calc.getModel(product_id);
+        WarmStartState* warm = warm_start_enabled ? &warm_starts[product_id] : nullptr;
+        return optimizeWithDemand([&](double price) {
+            return model.base_demand * std::pow(price / current_price, model.elasticity);
+        }, current_price, cost, min_comp, max_comp, inventory_level, target_inventory, warm);
+    }
+    
+    // Optimizes a compact model record; its reference price is the current
+    // price. A record without a positive reference price has flat demand.
+    OptimizationResult optimizeModel(const ProductModelRecord& model,
+                                     double cost,
+                                     double min_comp,
+                                     double max_comp,
+                                     int inventory_level,
+                                     int target_inventory,
+                                     WarmStartState* warm = nullptr,
+                                     SearchDeadline* deadline = nullptr) const {
+        double current_price = model.reference_price;
+        double elasticity = model.elasticity;
+        double base = model.base_demand;
+        return optimizeWithDemand([=](double price) {
+            return current_price > 0.0 ? base * std::pow(price / current_price, elasticity) : base;
+        }, current_price, cost, min_comp, max_comp, inventory_level, target_inventory, warm, deadline);
+    }
+    
+    // Off by default. When on, optimizePrice keeps one WarmStartState per
+    // product id for the optimizer's lifetime (clearWarmStart drops one) and
+    // mutates it on every call, so the optimizer must not be shared across
+    // threads. Callers that manage their own WarmStartState pass it to
+    // optimizeWithDemand or optimizeModel instead.
+    void setWarmStart(bool enabled) {
+        warm_start_enabled = enabled;
+        if (!enabled) {
+            warm_starts.clear();
+        }
+    }
+    
+    void clearWarmStart(const std::string& product_id) { warm_starts.erase(product_id); }
+    
+    void setPolicy(const PricingPolicy& pricing_policy) { policy = pricing_policy; }
+    const PricingPolicy& getPolicy() const { return policy; }
+    
+    void setSearchSettings(const SearchSettings& settings) { policy.search = settings; }
+    const SearchSettings& getSearchSettings() const { return policy.search; }
+    
+    double getElasticity(const std::string& product_id) const {
+        return elasticity_calc.getElasticity(product_id);
+    }
+    
+    const ElasticityCalculator& getElasticityCalculator() const { return elasticity_calc; }
+};
+
+// Online Gamma-Poisson posteriors for a whole catalog in SoA form. Each
+// period's purchase count k is a conjugate O(1) update
+//   alpha = prior_alpha + rho * (alpha - prior_alpha) + k
+//   beta  = prior_beta  + rho * (beta  - prior_beta)  + 1
+// where rho = 1 is the exact posterior and rho < 1 exponentially forgets old
+// periods toward the prior.
+class StreamingGammaPoissonStore {
+private:
+    std::vector<double> alpha;
+    std::vector<double> beta;
+    double prior_alpha;
+    double prior_beta;
+    double forgetting;
+    
+public:
+    StreamingGammaPoissonStore(std::size_t products, double a = 2.0, double b = 1.0, double rho = 1.0)
+        : alpha(products, a), beta(products, b), prior_alpha(a), prior_beta(b), forgetting(rho) {}
+    
+    void resize(std::size_t products) {
+        alpha.resize(products, prior_alpha);
+        beta.resize(products, prior_beta);
+    }
+    
+    void observe(uint32_t product, uint32_t purchases) {
+        alpha[product] = prior_alpha + forgetting * (alpha[product] - prior_alpha) + purchases;
+        beta[product] = prior_beta + forgetting * (beta[product] - prior_beta) + 1.0;
+    }
+    
+    // Folds several periods at once. The periods' exposure is discounted like
+    // that many observe() calls (sum of rho^j for j < periods); with
+    // forgetting the purchases are assumed spread evenly over the periods.
+    void observeAggregate(uint32_t product, uint64_t purchases, uint32_t periods) {
+        if (periods == 0) {
+            return;
+        }
+        double decay = 1.0, weight = periods;
+        if (forgetting != 1.0) {
+            decay = std::pow(forgetting, periods);
+            weight = (1.0 - decay) / (1.0 - forgetting);
+        }
+        alpha[product] = prior_alpha + decay * (alpha[product] - prior_alpha) +
+                         static_cast<double>(purchases) * weight / periods;
+        beta[product] = prior_beta + decay * (beta[product] - prior_beta) + weight;
+    }
+    
+    // One period for a subset of products. Each entry is a whole period, so
+    // products must be unique within a batch and purchases[i] must already
+    // be that product's total for the period; raw purchase events have to be
+    // aggregated first (see PurchaseEventIngestor).
+    void applyBatch(const uint32_t* products, const uint32_t* purchases, std::size_t n) {
+        const double a0 = prior_alpha, b0 = prior_beta, rho = forgetting;
+        double* a = alpha.data();
+        double* b = beta.data();
+        for (std::size_t i = 0; i < n; ++i) {
+            uint32_t p = products[i];
+            a[p] = a0 + rho * (a[p] - a0) + purchases[i];
+            b[p] = b0 + rho * (b[p] - b0) + 1.0;
+        }
+    }
+    
+    // One period for every product, purchases[i] belonging to product i.
+    void applyPeriod(const uint32_t* purchases) {
+        const double a0 = prior_alpha, b0 = prior_beta, rho = forgetting;
+        double* a = alpha.data();
+        double* b = beta.data();
+        for (std::size_t i = 0; i < alpha.size(); ++i) {
+            a[i] = a0 + rho * (a[i] - a0) + purchases[i];
+            b[i] = b0 + rho * (b[i] - b0) + 1.0;
+        }
+    }
+    
+    double getAlpha(uint32_t product) const { return alpha[product]; }
+    double getBeta(uint32_t product) const { return beta[product]; }
+    double getMean(uint32_t product) const { return alpha[product] / beta[product]; }
+    double getVariance(uint32_t product) const { return alpha[product] / (beta[product] * beta[product]); }
+    
+    GammaPoissonModel toModel(uint32_t product) const {
+        return GammaPoissonModel(alpha[product], beta[product]);
+    }
+    
+    void exportTo(ProductModelTable& table) const {
+        std::size_t n = std::min(table.size(), alpha.size());
+        for (std::size_t i = 0; i < n; ++i) {
+            table.setDemandModel(static_cast<uint32_t>(i), toModel(static_cast<uint32_t>(i)));
+        }
+    }
+    
+    std::size_t size() const { return alpha.size(); }
+    std::size_t memoryUsage() const { return (alpha.capacity() + beta.capacity()) * sizeof(double); }
+};
+
+struct PurchaseEvent {
+    uint32_t product;
+    uint32_t quantity;
+};
+
+// Bounded single-producer/single-consumer ring. Each side caches the other's
+// index and rereads it only when the ring looks full (or empty), so the
+// common path touches no shared cache line besides its own index.
+template <typename T>
+class SpscRing {
+private:
+    std::unique_ptr<T[]> slots;
+    std::size_t mask;
+    alignas(64) std::atomic<uint64_t> head{0};
+    uint64_t cached_tail = 0;
+    alignas(64) std::atomic<uint64_t> tail{0};
+    uint64_t cached_head = 0;
+    
+public:
+    explicit SpscRing(std::size_t capacity_pow2) : slots(new T[capacity_pow2]), mask(capacity_pow2 - 1) {}
+    
+    // Producer side; wait-free, false when full.
+    bool tryPush(const T& value) {
+        uint64_t t = tail.load(std::memory_order_relaxed);
+        if (t - cached_head > mask) {
+            cached_head = head.load(std::memory_order_acquire);
+            if (t - cached_head > mask) {
+                return false;
+            }
+        }
+        slots[t & mask] = value;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+    
+    // Consumer side.
+    std::size_t popBatch(T* out, std::size_t max) {
+        uint64_t h = head.load(std::memory_order_relaxed);
+        if (cached_tail == h) {
+            cached_tail = tail.load(std::memory_order_acquire);
+        }
+        std::size_t n = static_cast<std::size_t>(std::min<uint64_t>(cached_tail - h, max));
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] = slots[(h + i) & mask];
+        }
+        head.store(h + n, std::memory_order_release);
+        return n;
+    }
+    
+    std::size_t sizeApprox() const {
+        return static_cast<std::size_t>(tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire));
+    }
+    std::size_t capacity() const { return mask + 1; }
+};
+
+// Multi-producer purchase ingestion into StreamingGammaPoissonStore. Every
+// API worker owns an SPSC ring, so enqueue is wait-free and producers never
+// contend with each other; the single consumer drains the rings in batches
+// and scatter-adds quantities into per-product counts for the open period.
+// closePeriod() folds those counts into the posteriors as one conjugate
+// update per product.
+class PurchaseEventIngestor {
+public:
+    class Producer {
+    private:
+        SpscRing<PurchaseEvent> ring;
+        std::size_t high_watermark;
+        // Written only by the producer thread, readable from any thread.
+        std::atomic<uint64_t> rejected{0};
+        
+    public:
+        explicit Producer(std::size_t capacity)
+            : ring(capacity), high_watermark(capacity - capacity / 4) {}
+        
+        // False means the ring is full; the caller should back off or drop.
+        bool tryPush(uint32_t product, uint32_t quantity) {
+            if (ring.tryPush({product, quantity})) {
+                return true;
+            }
+            rejected.store(rejected.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+        
+        // Early back-pressure signal: the ring is more than 75% full.
+        bool underPressure() const { return ring.sizeApprox() >= high_watermark; }
+        uint64_t rejectedCount() const { return rejected.load(std::memory_order_relaxed); }
+        
+        SpscRing<PurchaseEvent>& queue() { return ring; }
+    };
+    
+private:
+    static constexpr std::size_t kDrainBatch = 4096;
+    
+    StreamingGammaPoissonStore& store;
+    std::vector<std::unique_ptr<Producer>> producers;
+    std::vector<uint32_t> period_counts;
+    std::vector<PurchaseEvent> batch;
+    uint64_t drained = 0;
+    uint64_t invalid = 0;
+    uint64_t periods = 0;
+    
+public:
+    PurchaseEventIngestor(StreamingGammaPoissonStore& models, std::size_t producer_count,
+                          std::size_t ring_capacity = 1 << 16)
+        : store(models), period_counts(models.size(), 0), batch(kDrainBatch) {
+        std::size_t pow2 = 1;
+        while (pow2 < ring_capacity) {
+            pow2 <<= 1;
+        }
+        for (std::size_t i = 0; i < producer_count; ++i) {
+            producers.push_back(std::make_unique<Producer>(pow2));
+        }
+    }
+    
+    Producer& producer(std::size_t index) { return *producers[index]; }
+    std::size_t producerCount() const { return producers.size(); }
+    
+    // Consumer side. Takes up to max_batches batches from each ring in turn
+    // and returns the number of events applied.
+    std::size_t drain(std::size_t max_batches = 4) {
+        std::size_t total = 0;
+        uint32_t* counts = period_counts.data();
+        const std::size_t products = period_counts.size();
+        for (auto& p : producers) {
+            for (std::size_t b = 0; b < max_batches; ++b) {
+                std::size_t n = p->queue().popBatch(batch.data(), batch.size());
+                for (std::size_t i = 0; i < n; ++i) {
+                    const PurchaseEvent& e = batch[i];
+                    if (e.product < products) {
+                        counts[e.product] += e.quantity;
+                    } else {
+                        ++invalid;
+                    }
+                }
+                total += n;
+                if (n < batch.size()) {
+                    break;
+                }
+            }
+        }
+        drained += total;
+        return total;
+    }
+    
+    void closePeriod() {
+        store.applyPeriod(period_counts.data());
+        std::fill(period_counts.begin(), period_counts.end(), 0u);
+        ++periods;
+    }
+    
+    uint64_t eventsDrained() const { return drained; }
+    uint64_t invalidEvents() const { return invalid; }
+    uint64_t periodsClosed() const { return periods; }
+};
+
+struct PriceChange {
+    uint32_t index;
+    double old_price;
+    double new_price;
+};
+
+struct RepricingTickStats {
+    std::size_t dirty;
+    std::size_t repriced;
+    std::size_t published;
+    double seconds;
+};
+
+// Reprices only products whose inputs changed since they were last priced.
+// Product indices match the ProductModelTable; a retrained model is picked up
+// through the record's version counter.
+class IncrementalRepricingEngine {
+private:
+    const ProductModelTable& models;
+    PriceOptimizer optimizer;
+    
+    std::vector<double> cost;
+    std::vector<double> min_comp;
+    std::vector<double> max_comp;
+    std::vector<int> inventory_level;
+    std::vector<int> target_inventory;
+    std::vector<int8_t> inventory_band;
+    std::vector<uint32_t> model_version;
+    std::vector<double> published_price;
+    std::vector<WarmStartState> warm;
+    
+    std::vector<uint32_t> dirty_list;
+    std::vector<uint8_t> dirty_flag;
+    std::vector<PriceChange> changes;
+    double publish_threshold = 0.005;
+    
+    int8_t inventoryBand(int level, int target) const {
+        const PricingPolicy& policy = optimizer.getPolicy();
+        if (level > target * policy.overstock_threshold) {
+            return 1;
+        }
+        if (level < target * policy.understock_threshold) {
+            return -1;
+        }
+        return 0;
+    }
+    
+    // Per-product arrays follow the model table as it grows; an index with no
+    // model is rejected rather than growing them.
+    void ensureCapacity(uint32_t index) {
+        if (index >= models.size()) {
+            throw std::out_of_range("no model for product " + std::to_string(index));
+        }
+        if (index < cost.size()) {
+            return;
+        }
+        std::size_t n = models.size();
+        cost.resize(n, 0.0);
+        min_comp.resize(n, 0.0);
+        max_comp.resize(n, 0.0);
+        inventory_level.resize(n, 0);
+        target_inventory.resize(n, 0);
+        inventory_band.resize(n, 0);
+        model_version.resize(n, 0);
+        published_price.resize(n, 0.0);
+        warm.resize(n);
+        dirty_flag.resize(n, 0);
+    }
+    
+public:
+    explicit IncrementalRepricingEngine(const ProductModelTable& model_table)
+        : models(model_table) {
+        if (models.size() > 0) {
+            ensureCapacity(static_cast<uint32_t>(models.size() - 1));
+        }
+    }
+    
+    void markDirty(uint32_t index) {
+        ensureCapacity(index);
+        if (!dirty_flag[index]) {
+            dirty_flag[index] = 1;
+            dirty_list.push_back(index);
+        }
+    }
+    
+    void setProduct(uint32_t index, double unit_cost, double min_competitor, double max_competitor,
+                    int inventory, int target) {
+        ensureCapacity(index);
+        cost[index] = unit_cost;
+        min_comp[index] = min_competitor;
+        max_comp[index] = max_competitor;
+        inventory_level[index] = inventory;
+        target_inventory[index] = target;
+        inventory_band[index] = inventoryBand(inventory, target);
+        markDirty(index);
+    }
+    
+    void setCost(uint32_t index, double unit_cost) {
+        ensureCapacity(index);
+        if (cost[index] != unit_cost) {
+            cost[index] = unit_cost;
+            markDirty(index);
+        }
+    }
+    
+    void setCompetitorBounds(uint32_t index, double min_competitor, double max_competitor) {
+        ensureCapacity(index);
+        if (min_comp[index] != min_competitor || max_comp[index] != max_competitor) {
+            min_comp[index] = min_competitor;
+            max_comp[index] = max_competitor;
+            markDirty(index);
+        }
+    }
+    
+    // Only a move into another inventory band changes the price bracket.
+    void setInventory(uint32_t index, int inventory) {
+        ensureCapacity(index);
+        inventory_level[index] = inventory;
+        int8_t band = inventoryBand(inventory, target_inventory[index]);
+        if (band != inventory_band[index]) {
+            inventory_band[index] = band;
+            markDirty(index);
+        }
+    }
+    
+    void modelUpdated(uint32_t index) {
+        if (index >= model_version.size() || models[index].version != model_version[index]) {
+            markDirty(index);
+        }
+    }
+    
+    const std::vector<PriceChange>& tick(RepricingTickStats* stats = nullptr) {
+        auto start = std::chrono::steady_clock::now();
+        changes.clear();
+        std::size_t dirty = dirty_list.size();
+        
+        std::size_t repriced = 0;
+        for (uint32_t index : dirty_list) {
+            if (!dirty_flag[index]) {
+                continue;
+            }
+            ++repriced;
+            PriceChange change;
+            if (reprice(index, change)) {
+                changes.push_back(change);
+            }
+        }
+        dirty_list.clear();
+        
+        if (stats) {
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            *stats = {dirty, repriced, changes.size(), seconds};
+        }
+        return changes;
+    }
+    
+    // Re-optimizes one product immediately and clears its dirty flag. Returns
+    // true and fills change when the published price moved.
+    bool reprice(uint32_t index, PriceChange& change) {
+        ensureCapacity(index);
+        dirty_flag[index] = 0;
+        const ProductModelRecord& model = models[index];
+        model_version[index] = model.version;
+        OptimizationResult r = optimizer.optimizeModel(model, cost[index], min_comp[index], max_comp[index],
+                                                       inventory_level[index], target_inventory[index],
+                                                       &warm[index]);
+        if (std::abs(r.optimal_price - published_price[index]) < publish_threshold) {
+            return false;
+        }
+        change = {index, published_price[index], r.optimal_price};
+        published_price[index] = r.optimal_price;
+        return true;
+    }
+    
+    void setPublishThreshold(double threshold) { publish_threshold = threshold; }
+    void setSearchSettings(const SearchSettings& settings) { optimizer.setSearchSettings(settings); }
+    
+    // Bands are recomputed and every product is marked dirty, since every
+    // product's bracket may have moved.
+    void setPolicy(const PricingPolicy& policy) {
+        optimizer.setPolicy(policy);
+        for (uint32_t i = 0; i < cost.size(); ++i) {
+            inventory_band[i] = inventoryBand(inventory_level[i], target_inventory[i]);
+            markDirty(i);
+        }
+    }
+    
+    double getPublishedPrice(uint32_t index) const { return published_price[index]; }
+    double getCost(uint32_t index) const { return cost[index]; }
+    double getMinCompetitor(uint32_t index) const { return min_comp[index]; }
+    double getMaxCompetitor(uint32_t index) const { return max_comp[index]; }
+    int getInventoryBand(uint32_t index) const { return inventory_band[index]; }
+    const ProductModelTable& getModels() const { return models; }
+    std::size_t dirtyCount() const { return dirty_list.size(); }
+    std::size_t size() const { return cost.size(); }
+};
+
+enum class PricingEventType : uint8_t {
+    CompetitorChange,
+    InventoryChange,
+    CostChange
+};
+
+// CompetitorChange: value/value2 are the new min/max competitor prices.
+// InventoryChange: value is the inventory level. CostChange: value is the cost.
+struct PricingEvent {
+    PricingEventType type;
+    uint32_t product;
+    double value;
+    double value2;
+};
+
+// Applies input events to an IncrementalRepricingEngine and schedules the
+// affected products by estimated revenue at stake, so that under load the
+// most valuable repricings run first. Priorities accumulate per product until
+// it is repriced. Each product holds at most one heap entry; an entry whose
+// priority grew after it was pushed is re-queued at its current priority when
+// it reaches the top.
+class EventDrivenRepricer {
+private:
+    struct QueueEntry {
+        double priority;
+        uint32_t product;
+        
+        bool operator<(const QueueEntry& other) const { return priority < other.priority; }
+    };
+    
+    IncrementalRepricingEngine& engine;
+    std::priority_queue<QueueEntry> queue;
+    std::vector<double> pending_priority;
+    std::vector<uint8_t> queued;
+    std::vector<PriceChange> changes;
+    uint64_t events_applied = 0;
+    uint64_t events_ignored = 0;
+    uint64_t events_rejected = 0;
+    
+    double currentRevenue(uint32_t index) const {
+        const ProductModelRecord& model = engine.getModels()[index];
+        double price = engine.getPublishedPrice(index) > 0.0 ? engine.getPublishedPrice(index)
+                                                             : model.reference_price;
+        double demand = model.reference_price > 0.0f
+            ? model.base_demand * std::pow(price / model.reference_price, static_cast<double>(model.elasticity))
+            : model.base_demand;
+        return price * demand;
+    }
+    
+    double revenueAtStake(const PricingEvent& event) const {
+        uint32_t i = event.product;
+        const ProductModelRecord& model = engine.getModels()[i];
+        double elasticity = std::abs(static_cast<double>(model.elasticity));
+        double price = std::max(1e-9, engine.getPublishedPrice(i) > 0.0 ? engine.getPublishedPrice(i)
+                                                                       : static_cast<double>(model.reference_price));
+        double revenue = currentRevenue(i);
+        
+        switch (event.type) {
+            case PricingEventType::CostChange: {
+                double units = revenue / price;
+                return units * std::abs(event.value - engine.getCost(i)) * (1.0 + elasticity);
+            }
+            case PricingEventType::CompetitorChange: {
+                double shift = std::max(std::abs(event.value - engine.getMinCompetitor(i)),
+                                        std::abs(event.value2 - engine.getMaxCompetitor(i)));
+                return revenue * (shift / price) * elasticity;
+            }
+            case PricingEventType::InventoryChange:
+                return revenue * 0.05 * elasticity;
+        }
+        return 0.0;
+    }
+    
+    void ensureCapacity(uint32_t index) {
+        if (index >= pending_priority.size()) {
+            std::size_t n = std::max<std::size_t>(index + 1, engine.size());
+            pending_priority.resize(n, 0.0);
+            queued.resize(n, 0);
+        }
+    }
+    
+public:
+    explicit EventDrivenRepricer(IncrementalRepricingEngine& repricing_engine)
+        : engine(repricing_engine) {
+        pending_priority.resize(engine.size(), 0.0);
+        queued.resize(engine.size(), 0);
+    }
+    
+    // Events for products without a model in the engine's table are rejected.
+    void submit(const PricingEvent& event) {
+        uint32_t i = event.product;
+        if (i >= engine.getModels().size()) {
+            ++events_rejected;
+            return;
+        }
+        ensureCapacity(i);
+        double stake = revenueAtStake(event);
+        int band_before = engine.getInventoryBand(i);
+        
+        switch (event.type) {
+            case PricingEventType::CostChange:
+                engine.setCost(i, event.value);
+                break;
+            case PricingEventType::CompetitorChange:
+                engine.setCompetitorBounds(i, event.value, event.value2);
+                break;
+            case PricingEventType::InventoryChange:
+                engine.setInventory(i, static_cast<int>(event.value));
+                if (engine.getInventoryBand(i) == band_before) {
+                    ++events_ignored;
+                    return;
+                }
+                break;
+        }
+        if (stake <= 0.0) {
+            ++events_ignored;
+            return;
+        }
+        
+        ++events_applied;
+        pending_priority[i] += stake;
+        if (!queued[i]) {
+            queued[i] = 1;
+            queue.push({pending_priority[i], i});
+        }
+    }
+    
+    void submit(const PricingEvent* events, std::size_t n) {
+        for (std::size_t k = 0; k < n; ++k) {
+            submit(events[k]);
+        }
+    }
+    
+    // Reprices up to max_repricings products in descending order of revenue
+    // at stake and returns the resulting published price changes.
+    const std::vector<PriceChange>& process(std::size_t max_repricings) {
+        changes.clear();
+        std::size_t done = 0;
+        while (done < max_repricings && !queue.empty()) {
+            QueueEntry top = queue.top();
+            queue.pop();
+            if (top.priority < pending_priority[top.product]) {
+                queue.push({pending_priority[top.product], top.product});
+                continue;
+            }
+            queued[top.product] = 0;
+            pending_priority[top.product] = 0.0;
+            ++done;
+            PriceChange change;
+            if (engine.reprice(top.product, change)) {
+                changes.push_back(change);
+            }
+        }
+        return changes;
+    }
+    
+    std::size_t backlog() const { return queue.size(); }
+    uint64_t eventsApplied() const { return events_applied; }
+    uint64_t eventsIgnored() const { return events_ignored; }
+    uint64_t eventsRejected() const { return events_rejected; }
+};
+
+// splitmix64 stream. The distributions are implemented here rather than taken
+// from <random>, whose algorithms differ between standard libraries; the
+// transcendental calls still go through libm, so draws are reproducible on a
+// given platform but not guaranteed bit-identical across libm versions.
+class SplitMix64 {
+private:
+    uint64_t state;
+    
+public:
+    explicit SplitMix64(uint64_t seed) : state(seed) {}
+    
+    static constexpr uint64_t kGolden = 0x9e3779b97f4a7c15ULL;
+    
+    static uint64_t finalize(uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+    
+    // Seed for an independent stream, e.g. one per product.
+    static uint64_t mix(uint64_t seed, uint64_t stream) { return finalize(seed + kGolden * (stream + 1)); }
+    
+    uint64_t next() { return finalize(state += kGolden); }
+    
+    double uniform() { return (next() >> 11) * 0x1.0p-53; }
+    double uniform(double lo, double hi) { return lo + (hi - lo) * uniform(); }
+    
+    double normal() {
+        double u1 = 1.0 - uniform();
+        double u2 = uniform();
+        return std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * M_PI * u2);
+    }
+    
+    // Marsaglia-Tsang with the shape < 1 boost; scale 1.
+    double gamma(double shape) {
+        if (shape < 1.0) {
+            return gamma(shape + 1.0) * std::pow(1.0 - uniform(), 1.0 / shape);
+        }
+        double d = shape - 1.0 / 3.0;
+        double c = 1.0 / std::sqrt(9.0 * d);
+        for (;;) {
+            double x = normal();
+            double v = 1.0 + c * x;
+            if (v <= 0.0) {
+                continue;
+            }
+            v = v * v * v;
+            double u = 1.0 - uniform();
+            if (std::log(u) < 0.5 * x * x + d - d * v + d * std::log(v)) {
+                return d * v;
+            }
+        }
+    }
+    
+    // Knuth's product method for small means, normal approximation above.
+    uint32_t poisson(double mean) {
+        if (mean <= 0.0) {
+            return 0;
+        }
+        if (mean < 30.0) {
+            double limit = std::exp(-mean);
+            double product = 1.0 - uniform();
+            uint32_t k = 0;
+            while (product > limit) {
+                ++k;
+                product *= 1.0 - uniform();
+            }
+            return k;
+        }
+        return static_cast<uint32_t>(std::max(0.0, std::round(mean + std::sqrt(mean) * normal())));
+    }
+};
+
+enum class BacktestEventType : uint8_t {
+    Sale,
+    CompetitorPrice,
+    Inventory
+};
+
+// Sale: realized units at the historical price over one demand period.
+// CompetitorPrice: an observed competitor price. Inventory: stock level.
+struct BacktestEvent {
+    int64_t timestamp;
+    uint32_t product;
+    BacktestEventType type;
+    double price;
+    double quantity;
+};
+
+struct BacktestConfig {
+    int64_t reprice_interval = 86400;
+    int target_inventory = 400;
+    uint64_t seed = 1;
+    unsigned threads = 0;
+};
+
+struct BacktestProductResult {
+    double realized_revenue = 0.0;
+    double realized_margin = 0.0;
+    double simulated_revenue = 0.0;
+    double simulated_margin = 0.0;
+    uint32_t repricings = 0;
+};
+
+struct BacktestReport {
+    std::size_t events = 0;
+    std::size_t rejected_events = 0;
+    std::size_t products = 0;
+    double realized_revenue = 0.0;
+    double realized_margin = 0.0;
+    double simulated_revenue = 0.0;
+    double simulated_margin = 0.0;
+    uint64_t repricings = 0;
+    double seconds = 0.0;
+    
+    double eventsPerSecond() const { return seconds > 0.0 ? events / seconds : 0.0; }
+};
+
+// Replays historical events through PriceOptimizer in simulated time and
+// simulates the policy's sales from each product's Gamma-Poisson model
+// (purchase rate at the reference price, scaled by elasticity). A record
+// without a valid Gamma prior simulates at its base demand instead. Each
+// product is replayed sequentially with its own seeded RNG, so results do not
+// depend on the number of threads; they are reproducible only within one
+// standard library, whose distribution algorithms are unspecified.
+class BacktestEngine {
+private:
+    const ProductModelTable& models;
+    std::vector<double> unit_costs;
+    BacktestConfig config;
+    
+    BacktestProductResult replayProduct(uint32_t product, const BacktestEvent* events, std::size_t n,
+                                        const PriceOptimizer& optimizer) const {
+        BacktestProductResult result;
+        const ProductModelRecord& model = models[product];
+        double cost = unit_costs[product];
+        double reference = model.reference_price;
+        double elasticity = model.elasticity;
+        double min_comp = reference * 0.8;
+        double max_comp = reference * 1.2;
+        int inventory = config.target_inventory;
+        
+        std::mt19937_64 rng(SplitMix64::mix(config.seed, product));
+        bool has_prior = model.alpha > 0.0f && model.beta > 0.0f &&
+                         std::isfinite(model.alpha) && std::isfinite(model.beta);
+        std::gamma_distribution<double> rate(has_prior ? model.alpha : 1.0, has_prior ? 1.0 / model.beta : 1.0);
+        double point_rate = std::max(0.0, static_cast<double>(model.base_demand));
+        WarmStartState warm;
+        double policy_price = reference;
+        int64_t next_reprice = std::numeric_limits<int64_t>::min();
+        
+        for (std::size_t k = 0; k < n; ++k) {
+            const BacktestEvent& e = events[k];
+            if (e.timestamp >= next_reprice) {
+                policy_price = optimizer.optimizeModel(model, cost, min_comp, max_comp, inventory,
+                                                       config.target_inventory, &warm).optimal_price;
+                next_reprice = e.timestamp + config.reprice_interval;
+                ++result.repricings;
+            }
+            
+            switch (e.type) {
+                case BacktestEventType::Sale: {
+                    result.realized_revenue += e.price * e.quantity;
+                    result.realized_margin += (e.price - cost) * e.quantity;
+                    double lambda = has_prior ? rate(rng) : point_rate;
+                    if (reference > 0.0) {
+                        lambda *= std::pow(policy_price / reference, elasticity);
+                    }
+                    double units = lambda > 0.0 && std::isfinite(lambda)
+                        ? std::poisson_distribution<int>(lambda)(rng) : 0.0;
+                    result.simulated_revenue += policy_price * units;
+                    result.simulated_margin += (policy_price - cost) * units;
+                    break;
+                }
+                case BacktestEventType::CompetitorPrice:
+                    min_comp = std::min(e.price, reference * 0.95);
+                    max_comp = std::max(e.price, reference * 1.05);
+                    break;
+                case BacktestEventType::Inventory:
+                    inventory = static_cast<int>(e.quantity);
+                    break;
+            }
+        }
+        return result;
+    }
+    
+public:
+    BacktestEngine(const ProductModelTable& model_table, std::vector<double> costs,
+                   const BacktestConfig& backtest_config = BacktestConfig())
+        : models(model_table), unit_costs(std::move(costs)), config(backtest_config) {
+        if (unit_costs.size() < models.size()) {
+            throw std::invalid_argument("backtest has " + std::to_string(unit_costs.size()) +
+                                        " unit costs for " + std::to_string(models.size()) + " products");
+        }
+    }
+    
+    // Events may arrive in any order; they are grouped by product and replayed
+    // in timestamp order. Events for products outside the model table are
+    // skipped and counted in rejected_events. Per-product results are written
+    // to per_product when given.
+    BacktestReport run(const std::vector<BacktestEvent>& events,
+                       std::vector<BacktestProductResult>* per_product = nullptr) const {
+        auto start = std::chrono::steady_clock::now();
+        std::size_t products = models.size();
+        
+        std::vector<std::size_t> offsets(products + 1, 0);
+        std::size_t rejected = 0;
+        for (const auto& e : events) {
+            if (e.product < products) {
+                ++offsets[e.product + 1];
+            } else {
+                ++rejected;
+            }
+        }
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+        std::vector<BacktestEvent> grouped(events.size() - rejected);
+        std::vector<std::size_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (const auto& e : events) {
+            if (e.product < products) {
+                grouped[cursor[e.product]++] = e;
+            }
+        }
+        
+        std::vector<BacktestProductResult> results(products);
+        unsigned threads = config.threads ? config.threads : std::max(1u, std::thread::hardware_concurrency());
+        threads = static_cast<unsigned>(std::min<std::size_t>(threads, std::max<std::size_t>(products, 1)));
+        std::atomic<std::size_t> next{0};
+        const std::size_t batch = 256;
+        
+        auto worker = [&]() {
+            PriceOptimizer optimizer;
+            for (;;) {
+                std::size_t first = next.fetch_add(batch);
+                if (first >= products) {
+                    break;
+                }
+                std::size_t last = std::min(products, first + batch);
+                for (std::size_t p = first; p < last; ++p) {
+                    BacktestEvent* begin = grouped.data() + offsets[p];
+                    BacktestEvent* end = grouped.data() + offsets[p + 1];
+                    if (!std::is_sorted(begin, end, [](const BacktestEvent& a, const BacktestEvent& b) {
+                            return a.timestamp < b.timestamp;
+                        })) {
+                        std::stable_sort(begin, end, [](const BacktestEvent& a, const BacktestEvent& b) {
+                            return a.timestamp < b.timestamp;
+                        });
+                    }
+                    results[p] = replayProduct(static_cast<uint32_t>(p), begin, end - begin, optimizer);
+                }
+            }
+        };
+        
+        std::vector<std::thread> pool;
+        for (unsigned t = 1; t < threads; ++t) {
+            pool.emplace_back(worker);
+        }
+        worker();
+        for (auto& t : pool) {
+            t.join();
+        }
+        
+        BacktestReport report;
+        report.events = events.size() - rejected;
+        report.rejected_events = rejected;
+        report.products = products;
+        for (const auto& r : results) {
+            report.realized_revenue += r.realized_revenue;
+            report.realized_margin += r.realized_margin;
+            report.simulated_revenue += r.simulated_revenue;
+            report.simulated_margin += r.simulated_margin;
+            report.repricings += r.repricings;
+        }
+        report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (per_product) {
+            *per_product = std::move(results);
+        }
+        return report;
+    }
+};
+
+struct SweepProduct {
+    double current_price;
+    double cost;
+    double min_comp;
+    double max_comp;
+    int inventory_level;
+    int target_inventory;
+    double elasticity;
+    double base_demand;
+};
+
+struct PolicySweepResult {
+    std::size_t policy;
+    double profit;
+    double revenue;
+    double units;
+    double mean_price;
+    int64_t evaluations;
+};
+
+// Evaluates many PricingPolicy variants against one catalog in parallel.
+// Everything that does not depend on the policy (SoA layout, log of the
+// current price, elasticity lookups) is prepared once and shared. Each
+// objective evaluation still costs one log and one exp: the line search picks
+// arbitrary prices, so log(price) cannot be tabulated, and folding the
+// constants into a single pow measured slower with glibc.
+class PolicySweep {
+private:
+    std::vector<double> current_price;
+    std::vector<double> log_current_price;
+    std::vector<double> cost;
+    std::vector<double> min_comp;
+    std::vector<double> max_comp;
+    std::vector<int> inventory_level;
+    std::vector<int> target_inventory;
+    std::vector<double> elasticity;
+    std::vector<double> base_demand;
+    
+    PolicySweepResult evaluate(std::size_t index, const PricingPolicy& policy) const {
+        PriceOptimizer optimizer;
+        optimizer.setWarmStart(false);
+        optimizer.setPolicy(policy);
+        PolicySweepResult result{index, 0.0, 0.0, 0.0, 0.0, 0};
+        
+        for (std::size_t i = 0; i < current_price.size(); ++i) {
+            double log_current = log_current_price[i];
+            double e = elasticity[i];
+            double base = base_demand[i];
+            OptimizationResult r = optimizer.optimizeWithDemand([=](double price) {
+                return base * std::exp(e * (std::log(price) - log_current));
+            }, current_price[i], cost[i], min_comp[i], max_comp[i], inventory_level[i], target_inventory[i]);
+            result.profit += r.expected_revenue;
+            result.revenue += r.optimal_price * r.expected_demand;
+            result.units += r.expected_demand;
+            result.mean_price += r.optimal_price;
+            result.evaluations += r.objective_evaluations;
+        }
+        if (!current_price.empty()) {
+            result.mean_price /= current_price.size();
+        }
+        return result;
+    }
+    
+public:
+    explicit PolicySweep(const std::vector<SweepProduct>& catalog) {
+        std::size_t n = catalog.size();
+        for (auto* v : {&current_price, &log_current_price, &cost, &min_comp, &max_comp, &elasticity, &base_demand}) {
+            v->reserve(n);
+        }
+        inventory_level.reserve(n);
+        target_inventory.reserve(n);
+        for (const auto& p : catalog) {
+            current_price.push_back(p.current_price);
+            log_current_price.push_back(std::log(p.current_price));
+            cost.push_back(p.cost);
+            min_comp.push_back(p.min_comp);
+            max_comp.push_back(p.max_comp);
+            inventory_level.push_back(p.inventory_level);
+            target_inventory.push_back(p.target_inventory);
+            elasticity.push_back(p.elasticity);
+            base_demand.push_back(p.base_demand);
+        }
+    }
+    
+    std::vector<PolicySweepResult> run(const std::vector<PricingPolicy>& policies, unsigned threads = 0) const {
+        std::vector<PolicySweepResult> results(policies.size());
+        threads = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+        threads = static_cast<unsigned>(std::min<std::size_t>(threads, std::max<std::size_t>(policies.size(), 1)));
+        std::atomic<std::size_t> next{0};
+        
+        auto worker = [&]() {
+            for (std::size_t k = next.fetch_add(1); k < policies.size(); k = next.fetch_add(1)) {
+                results[k] = evaluate(k, policies[k]);
+            }
+        };
+        std::vector<std::thread> pool;
+        for (unsigned t = 1; t < threads; ++t) {
+            pool.emplace_back(worker);
+        }
+        worker();
+        for (auto& t : pool) {
+            t.join();
+        }
+        return results;
+    }
+    
+    // Random variants around base; every knob is scaled by an independent
+    // factor in [1 - spread, 1 + spread].
+    static std::vector<PricingPolicy> randomVariants(const PricingPolicy& base, std::size_t count,
+                                                     double spread = 0.1, uint64_t seed = 1) {
+        std::mt19937_64 rng(seed);
+        std::uniform_real_distribution<double> jitter(1.0 - spread, 1.0 + spread);
+        std::vector<PricingPolicy> variants;
+        variants.reserve(count);
+        variants.push_back(base);
+        while (variants.size() < count) {
+            PricingPolicy p = base;
+            for (double* knob : {&p.overstock_threshold, &p.understock_threshold, &p.overstock_factor,
+                                 &p.understock_factor, &p.cost_markup, &p.competitor_floor,
+                                 &p.current_price_cap, &p.competitor_ceiling}) {
+                *knob *= jitter(rng);
+            }
+            p.search.absolute_tolerance *= jitter(rng);
+            variants.push_back(p);
+        }
+        return variants;
+    }
+    
+    std::size_t size() const { return current_price.size(); }
+};
+
+constexpr int kPrecisionLevels = 4;
+
+struct DeadlinePriceResult {
+    double price;
+    double price_tolerance;
+    int evaluations;
+    uint8_t precision_level;
+    bool fallback;
+};
+
+struct DeadlineBatchReport {
+    std::size_t products = 0;
+    std::array<std::size_t, kPrecisionLevels> per_level{};
+    std::size_t fallbacks = 0;
+    double seconds = 0.0;
+    bool deadline_met = true;
+};
+
+// Prices a batch against one global deadline by trading precision for time.
+// Products are processed in blocks; before each block the scheduler divides
+// the remaining budget by the remaining products and picks the most precise
+// search level whose measured cost per product fits. Searches poll the same
+// deadline, and products not reached before it get their current price
+// clamped into the policy bracket, flagged as fallbacks.
+class DeadlineBatchScheduler {
+private:
+    static constexpr int kLevels = kPrecisionLevels;
+    static constexpr std::size_t kBlock = 16;
+    static constexpr double kHeadroom = 0.8;
+    static constexpr double kFallbackNs = 25.0;
+    
+    std::array<PriceOptimizer, kLevels> optimizers;
+    std::array<double, kLevels> ns_per_product{};
+    
+    double estimate(int level) const {
+        if (ns_per_product[level] > 0.0) {
+            return ns_per_product[level];
+        }
+        for (int l = 0; l < kLevels; ++l) {
+            if (ns_per_product[l] > 0.0) {
+                return ns_per_product[l] * optimizers[level].getSearchSettings().max_evaluations /
+                       optimizers[l].getSearchSettings().max_evaluations;
+            }
+        }
+        return 0.0;
+    }
+    
+public:
+    explicit DeadlineBatchScheduler(const PricingPolicy& policy = PricingPolicy()) {
+        static const double kAbsoluteTolerance[kLevels] = {0.0, 0.01, 0.05, 0.25};
+        static const int kMaxEvaluations[kLevels] = {0, 24, 12, 6};
+        for (int l = 0; l < kLevels; ++l) {
+            PricingPolicy p = policy;
+            if (l > 0) {
+                p.search.method = LineSearchMethod::Brent;
+                p.search.relative_tolerance = 0.0;
+                p.search.absolute_tolerance = std::max(kAbsoluteTolerance[l], policy.search.absolute_tolerance);
+                p.search.max_evaluations = std::min(kMaxEvaluations[l], policy.search.max_evaluations);
+            }
+            optimizers[l].setPolicy(p);
+            optimizers[l].setWarmStart(false);
+        }
+    }
+    
+    DeadlineBatchReport run(const SweepProduct* products, std::size_t n,
+                            std::chrono::steady_clock::time_point deadline_at, DeadlinePriceResult* out) {
+        DeadlineBatchReport report;
+        report.products = n;
+        auto start = std::chrono::steady_clock::now();
+        auto block_start = start;
+        
+        std::size_t i = 0;
+        while (i < n) {
+            std::size_t end = std::min(n, i + kBlock);
+            double reserve_ns = kFallbackNs * (n - end);
+            double remaining_ns = std::chrono::duration<double, std::nano>(deadline_at - block_start).count() -
+                                  reserve_ns;
+            if (remaining_ns <= 0.0) {
+                break;
+            }
+            double budget = remaining_ns * kHeadroom / (n - i);
+            int level = 0;
+            while (level + 1 < kLevels && estimate(level) > budget) {
+                ++level;
+            }
+            
+            // Searches in this block must leave time to fall back on the rest.
+            SearchDeadline deadline(deadline_at - std::chrono::nanoseconds(static_cast<int64_t>(reserve_ns)));
+            const PriceOptimizer& optimizer = optimizers[level];
+            std::size_t block_first = i;
+            bool expired = false;
+            for (; i < end && !expired; ++i) {
+                const SweepProduct& p = products[i];
+                double current = p.current_price, elasticity = p.elasticity, base = p.base_demand;
+                OptimizationResult r = optimizer.optimizeWithDemand([=](double price) {
+                    return base * std::pow(price / current, elasticity);
+                }, current, p.cost, p.min_comp, p.max_comp, p.inventory_level, p.target_inventory,
+                   nullptr, &deadline);
+                out[i] = {r.optimal_price, r.price_tolerance, r.objective_evaluations,
+                          static_cast<uint8_t>(level), false};
+                ++report.per_level[level];
+                expired = r.deadline_expired;
+            }
+            
+            // Outliers (preemption, page faults) are clamped so one slow block
+            // does not push the rest of the batch to low precision.
+            auto now = std::chrono::steady_clock::now();
+            double measured = std::chrono::duration<double, std::nano>(now - block_start).count() /
+                              (i - block_first);
+            double& ewma = ns_per_product[level];
+            ewma = ewma > 0.0 ? 0.8 * ewma + 0.2 * std::min(measured, 4.0 * ewma) : measured;
+            block_start = now;
+            if (expired) {
+                break;
+            }
+        }
+        
+        const PricingPolicy& policy = optimizers[0].getPolicy();
+        for (; i < n; ++i) {
+            const SweepProduct& p = products[i];
+            auto [lo, hi] = policy.bracket(p.current_price, p.cost, p.min_comp, p.max_comp,
+                                           p.inventory_level, p.target_inventory);
+            double price = lo < hi ? std::min(std::max(p.current_price, lo), hi) : p.current_price;
+            out[i] = {price, lo < hi ? hi - lo : 0.0, 0, static_cast<uint8_t>(kLevels - 1), true};
+            ++report.fallbacks;
+        }
+        auto finished = std::chrono::steady_clock::now();
+        report.seconds = std::chrono::duration<double>(finished - start).count();
+        report.deadline_met = finished <= deadline_at;
+        return report;
+    }
+};
+
+enum class RequestLane : uint8_t {
+    Checkout = 0,
+    Batch = 1
+};
+
+constexpr int kRequestLanes = 2;
+
+enum class ResponseSource : uint8_t {
+    Optimized,
+    Cached
+};
+
+struct PricingRequest {
+    uint32_t product;
+    RequestLane lane;
+    std::chrono::steady_clock::time_point enqueued;
+};
+
+struct PricingResponse {
+    uint32_t product;
+    RequestLane lane;
+    ResponseSource source;
+    double price;
+    std::chrono::steady_clock::time_point enqueued;
+};
+
+// A lane's queue bound, latency SLO and the most workers it may occupy at
+// once; keeping batch below the worker count reserves capacity for checkout.
+struct AdmissionLaneConfig {
+    std::size_t queue_capacity;
+    double slo_ms;
+    unsigned max_concurrency;
+};
+
+struct AdmissionConfig {
+    unsigned workers = 4;
+    std::array<AdmissionLaneConfig, kRequestLanes> lanes = {{{1024, 2.0, 4}, {4096, 250.0, 2}}};
+    double service_ewma_weight = 0.05;
+    // Off: one unbounded FIFO across lanes with no shedding, for comparison.
+    bool enabled = true;
+};
+
+struct AdmissionLaneStats {
+    uint64_t admitted = 0;
+    uint64_t completed = 0;
+    uint64_t shed_queue_full = 0;
+    uint64_t shed_predicted = 0;
+    uint64_t shed_expired = 0;
+    uint64_t shed_stopped = 0;
+    uint64_t deadline_cut = 0;
+    std::size_t queue_depth = 0;
+    double service_ewma_us = 0.0;
+    
+    uint64_t shed() const { return shed_queue_full + shed_predicted + shed_expired + shed_stopped; }
+};
+
+// In-process pricing daemon core with admission control. Requests enter a
+// bounded per-lane queue; workers always serve checkout before batch and
+// respect each lane's concurrency cap. A request is shed when its queue is
+// full, when the predicted wait (queue depth x EWMA service time / lane
+// concurrency) would break its SLO, or when it is dequeued after its SLO has
+// passed. Shed requests are answered with the last published price, and
+// admitted searches are cut off at the request's SLO deadline. stop() answers
+// every still-queued request and every later submit() from the cache; only
+// searches already running are finished.
+class PricingServer {
+public:
+    using Responder = std::function<void(const PricingResponse&)>;
+    
+private:
+    struct Lane {
+        AdmissionLaneConfig config;
+        std::deque<PricingRequest> queue;
+        unsigned in_flight = 0;
+        double service_ewma_ns = 0.0;
+        AdmissionLaneStats stats;
+    };
+    
+    const std::vector<SweepProduct>& catalog;
+    PriceOptimizer optimizer;
+    std::unique_ptr<std::atomic<double>[]> published;
+    AdmissionConfig config;
+    Responder responder;
+    
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::array<Lane, kRequestLanes> lanes;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+    
+    static std::chrono::nanoseconds slo(const Lane& lane) {
+        return std::chrono::nanoseconds(static_cast<int64_t>(lane.config.slo_ms * 1e6));
+    }
+    
+    void respondCached(const PricingRequest& request) {
+        responder({request.product, request.lane, ResponseSource::Cached,
+                   published[request.product].load(std::memory_order_relaxed), request.enqueued});
+    }
+    
+    // Called with the mutex held.
+    int pickLane() {
+        if (!config.enabled) {
+            int best = -1;
+            for (int l = 0; l < kRequestLanes; ++l) {
+                if (!lanes[l].queue.empty() &&
+                    (best < 0 || lanes[l].queue.front().enqueued < lanes[best].queue.front().enqueued)) {
+                    best = l;
+                }
+            }
+            return best;
+        }
+        for (int l = 0; l < kRequestLanes; ++l) {
+            if (!lanes[l].queue.empty() && lanes[l].in_flight < lanes[l].config.max_concurrency) {
+                return l;
+            }
+        }
+        return -1;
+    }
+    
+    void workerLoop() {
+        for (;;) {
+            PricingRequest request;
+            int l;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready.wait(lock, [&]() { return stopping || pickLane() >= 0; });
+                l = pickLane();
+                if (l < 0) {
+                    return;
+                }
+                Lane& lane = lanes[l];
+                request = lane.queue.front();
+                lane.queue.pop_front();
+                ++lane.in_flight;
+            }
+            
+            Lane& lane = lanes[l];
+            auto deadline_at = request.enqueued + slo(lane);
+            auto start = std::chrono::steady_clock::now();
+            if (config.enabled && start >= deadline_at) {
+                respondCached(request);
+                std::lock_guard<std::mutex> lock(mutex);
+                --lane.in_flight;
+                ++lane.stats.shed_expired;
+                ready.notify_one();
+                continue;
+            }
+            
+            const SweepProduct& p = catalog[request.product];
+            double current = p.current_price, elasticity = p.elasticity, base = p.base_demand;
+            SearchDeadline deadline = config.enabled ? SearchDeadline(deadline_at) : SearchDeadline();
+            OptimizationResult r = optimizer.optimizeWithDemand([=](double price) {
+                return base * std::pow(price / current, elasticity);
+            }, current, p.cost, p.min_comp, p.max_comp, p.inventory_level, p.target_inventory, nullptr, &deadline);
+            published[request.product].store(r.optimal_price, std::memory_order_relaxed);
+            responder({request.product, request.lane, ResponseSource::Optimized, r.optimal_price, request.enqueued});
+            double service_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            
+            std::lock_guard<std::mutex> lock(mutex);
+            --lane.in_flight;
+            ++lane.stats.completed;
+            lane.stats.deadline_cut += r.deadline_expired;
+            lane.service_ewma_ns = lane.service_ewma_ns > 0.0
+                ? lane.service_ewma_ns + config.service_ewma_weight * (service_ns - lane.service_ewma_ns)
+                : service_ns;
+            ready.notify_one();
+        }
+    }
+    
+public:
+    PricingServer(const std::vector<SweepProduct>& products, Responder respond,
+                  const AdmissionConfig& cfg = AdmissionConfig())
+        : catalog(products), published(new std::atomic<double>[products.size()]), config(cfg),
+          responder(std::move(respond)) {
+        for (std::size_t i = 0; i < products.size(); ++i) {
+            published[i].store(products[i].current_price, std::memory_order_relaxed);
+        }
+        for (int l = 0; l < kRequestLanes; ++l) {
+            lanes[l].config = config.lanes[l];
+        }
+        optimizer.setWarmStart(false);
+        for (unsigned w = 0; w < std::max(1u, config.workers); ++w) {
+            workers.emplace_back([this]() { workerLoop(); });
+        }
+    }
+    
+    ~PricingServer() { stop(); }
+    
+    PricingServer(const PricingServer&) = delete;
+    PricingServer& operator=(const PricingServer&) = delete;
+    
+    // Returns false when the request was shed; its cached price has then
+    // already been sent to the responder. Throws out_of_range for a product
+    // outside the catalog.
+    bool submit(uint32_t product, RequestLane lane_id) {
+        if (product >= catalog.size() || static_cast<int>(lane_id) >= kRequestLanes) {
+            throw std::out_of_range("no pricing lane or product " + std::to_string(product));
+        }
+        PricingRequest request{product, lane_id, std::chrono::steady_clock::now()};
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            Lane& lane = lanes[static_cast<int>(lane_id)];
+            bool admit = true;
+            if (stopping) {
+                ++lane.stats.shed_stopped;
+                admit = false;
+            } else if (config.enabled) {
+                double concurrency = std::min(lane.config.max_concurrency, std::max(1u, config.workers));
+                double predicted_ns = (lane.queue.size() / concurrency + 1.0) * lane.service_ewma_ns;
+                if (lane.queue.size() >= lane.config.queue_capacity) {
+                    ++lane.stats.shed_queue_full;
+                    admit = false;
+                } else if (predicted_ns > lane.config.slo_ms * 1e6) {
+                    ++lane.stats.shed_predicted;
+                    admit = false;
+                }
+            }
+            if (admit) {
+                lane.queue.push_back(request);
+                ++lane.stats.admitted;
+                ready.notify_one();
+                return true;
+            }
+        }
+        respondCached(request);
+        return false;
+    }
+    
+    void stop() {
+        std::vector<PricingRequest> drained;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping) {
+                return;
+            }
+            stopping = true;
+            for (auto& lane : lanes) {
+                lane.stats.shed_stopped += lane.queue.size();
+                drained.insert(drained.end(), lane.queue.begin(), lane.queue.end());
+                lane.queue.clear();
+            }
+        }
+        ready.notify_all();
+        for (const auto& request : drained) {
+            respondCached(request);
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        workers.clear();
+    }
+    
+    double publishedPrice(uint32_t product) const { return published[product].load(std::memory_order_relaxed); }
+    
+    AdmissionLaneStats laneStats(RequestLane lane_id) {
+        std::lock_guard<std::mutex> lock(mutex);
+        const Lane& lane = lanes[static_cast<int>(lane_id)];
+        AdmissionLaneStats stats = lane.stats;
+        stats.queue_depth = lane.queue.size();
+        stats.service_ewma_us = lane.service_ewma_ns / 1000.0;
+        return stats;
+    }
+    
+    void writeStats(JsonWriter& json) {
+        static const char* kLaneNames[kRequestLanes] = {"checkout", "batch"};
+        json.beginObject();
+        for (int l = 0; l < kRequestLanes; ++l) {
+            AdmissionLaneStats s = laneStats(static_cast<RequestLane>(l));
+            json.key(kLaneNames[l]).beginObject();
+            json.field("admitted", s.admitted);
+            json.field("completed", s.completed);
+            json.field("shed_queue_full", s.shed_queue_full);
+            json.field("shed_predicted", s.shed_predicted);
+            json.field("shed_expired", s.shed_expired);
+            json.field("shed_stopped", s.shed_stopped);
+            json.field("deadline_cut", s.deadline_cut);
+            json.field("queue_depth", static_cast<uint64_t>(s.queue_depth));
+            json.field("service_ewma_us", s.service_ewma_us);
+            json.endObject();
+        }
+        json.endObject();
+    }
+};
+
+struct ParetoPoint {
+    float price;
+    float profit;
+    float units;
+    float revenue;
+};
+
+// Per-product Pareto frontiers of (profit, units, revenue) over the feasible
+// price bracket, stored CSR-style: product i owns points
+// [offsets[i], offsets[i + 1]), sorted by ascending price.
+//
+// Only prices that trade one objective against another survive, so the
+// frontier size depends on where the profit and revenue optima fall in each
+// bracket. On the --pareto catalog it measures 276 B/product at the default
+// 32 points (17 kept on average, plus the offset) and 541 B/product at 64.
+class ParetoFrontierSet {
+private:
+    static constexpr std::size_t kGridBlock = 8;
+    
+    std::vector<uint32_t> offsets{0};
+    std::vector<ParetoPoint> points;
+    
+public:
+    // Samples grid_points geometrically spaced prices across each product's
+    // bracket in one pass over the catalog and keeps the non-dominated ones.
+    static ParetoFrontierSet build(const std::vector<SweepProduct>& catalog,
+                                   const PricingPolicy& policy = PricingPolicy(),
+                                   int grid_points = 32) {
+        ParetoFrontierSet set;
+        set.offsets.reserve(catalog.size() + 1);
+        set.points.reserve(catalog.size() * 8);
+        
+        const std::size_t k = static_cast<std::size_t>(std::max(grid_points, 2));
+        std::vector<double> price(k), units(k), profit(k), revenue(k);
+        std::vector<std::size_t> kept;
+        kept.reserve(k);
+        
+        for (const auto& p : catalog) {
+            auto [lo, hi] = policy.bracket(p.current_price, p.cost, p.min_comp, p.max_comp,
+                                           p.inventory_level, p.target_inventory);
+            lo = std::max(lo, 1e-6);
+            hi = std::max(hi, lo);
+            
+            // Geometric grid: price and constant-elasticity demand are both
+            // powers of a per-product ratio, so a product costs three pow()
+            // calls in total. The first kGridBlock powers are tabulated and
+            // each block scales them by the block's predecessor, leaving a
+            // serial dependency only between blocks.
+            double ratio = std::pow(hi / lo, 1.0 / static_cast<double>(k - 1));
+            double units_ratio = std::pow(ratio, p.elasticity);
+            std::array<double, kGridBlock> price_step, units_step;
+            price_step[0] = ratio;
+            units_step[0] = units_ratio;
+            for (std::size_t t = 1; t < kGridBlock; ++t) {
+                price_step[t] = price_step[t - 1] * ratio;
+                units_step[t] = units_step[t - 1] * units_ratio;
+            }
+            price[0] = lo;
+            units[0] = p.base_demand * std::pow(lo / p.current_price, p.elasticity);
+            for (std::size_t j = 1; j < k; j += kGridBlock) {
+                double price_base = price[j - 1];
+                double units_base = units[j - 1];
+                std::size_t n = std::min(kGridBlock, k - j);
+                for (std::size_t t = 0; t < n; ++t) {
+                    price[j + t] = price_base * price_step[t];
+                    units[j + t] = units_base * units_step[t];
+                }
+            }
+            for (std::size_t j = 0; j < k; ++j) {
+                revenue[j] = price[j] * units[j];
+                profit[j] = (price[j] - p.cost) * units[j];
+            }
+            
+            // Scan in order of non-increasing units, so every earlier point
+            // already beats the current one on units; the current point is
+            // dominated iff an earlier kept point also matches it on both
+            // profit and revenue.
+            kept.clear();
+            bool ascending = p.elasticity < 0.0;
+            double max_profit = -std::numeric_limits<double>::infinity();
+            double max_revenue = -std::numeric_limits<double>::infinity();
+            for (std::size_t step_index = 0; step_index < k; ++step_index) {
+                std::size_t j = ascending ? step_index : k - 1 - step_index;
+                bool dominated = false;
+                if (profit[j] <= max_profit && revenue[j] <= max_revenue) {
+                    for (auto q = kept.rbegin(); q != kept.rend(); ++q) {
+                        if (profit[*q] >= profit[j] && revenue[*q] >= revenue[j]) {
+                            dominated = true;
+                            break;
+                        }
+                    }
+                }
+                max_profit = std::max(max_profit, profit[j]);
+                max_revenue = std::max(max_revenue, revenue[j]);
+                if (!dominated) {
+                    kept.push_back(j);
+                }
+            }
+            if (!ascending) {
+                std::reverse(kept.begin(), kept.end());
+            }
+            for (std::size_t j : kept) {
+                set.points.push_back({static_cast<float>(price[j]), static_cast<float>(profit[j]),
+                                      static_cast<float>(units[j]), static_cast<float>(revenue[j])});
+            }
+            set.offsets.push_back(static_cast<uint32_t>(set.points.size()));
+        }
+        return set;
+    }
+    
+    std::size_t size() const { return offsets.size() - 1; }
+    std::size_t pointCount() const { return points.size(); }
+    const ParetoPoint* frontier(std::size_t product) const { return points.data() + offsets[product]; }
+    std::size_t frontierSize(std::size_t product) const { return offsets[product + 1] - offsets[product]; }
+    
+    // Trade-off slider: the frontier point maximizing the weighted sum of
+    // objectives, each normalized by its best value on the frontier.
+    const ParetoPoint& select(std::size_t product, double profit_weight, double units_weight,
+                              double revenue_weight) const {
+        const ParetoPoint* f = frontier(product);
+        std::size_t n = frontierSize(product);
+        float max_profit = 1e-12f, max_units = 1e-12f, max_revenue = 1e-12f;
+        for (std::size_t i = 0; i < n; ++i) {
+            max_profit = std::max(max_profit, std::abs(f[i].profit));
+            max_units = std::max(max_units, f[i].units);
+            max_revenue = std::max(max_revenue, f[i].revenue);
+        }
+        std::size_t best = 0;
+        double best_score = -std::numeric_limits<double>::infinity();
+        for (std::size_t i = 0; i < n; ++i) {
+            double score = profit_weight * f[i].profit / max_profit + units_weight * f[i].units / max_units +
+                           revenue_weight * f[i].revenue / max_revenue;
+            if (score > best_score) {
+                best_score = score;
+                best = i;
+            }
+        }
+        return f[best];
+    }
+    
+    std::size_t memoryUsage() const {
+        return offsets.capacity() * sizeof(uint32_t) + points.capacity() * sizeof(ParetoPoint);
+    }
+    
+    void shrinkToFit() {
+        offsets.shrink_to_fit();
+        points.shrink_to_fit();
+    }
+};
+
+// Owns a POSIX file descriptor and closes it on destruction.
+class UniqueFd {
+private:
+    int fd;
+    
+public:
+    explicit UniqueFd(int descriptor = -1) : fd(descriptor) {}
+    UniqueFd(const UniqueFd&) = delete;
+    UniqueFd& operator=(const UniqueFd&) = delete;
+    UniqueFd(UniqueFd&& other) noexcept : fd(other.fd) { other.fd = -1; }
+    
+    ~UniqueFd() {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+    
+    int get() const { return fd; }
+};
+
+// Append-only binary log of optimizer observations. Records are buffered and
+// written with one fdatasync per batch; a torn tail left by a crash is
+// detected by checksum and truncated on open.
+class ObservationJournal {
+private:
+    struct FileHeader {
+        uint64_t magic;
+        uint32_t format_version;
+        uint32_t dimension;
+    };
+    
+    static constexpr uint64_t kMagic = 0x4f42534a524e4c31ULL;
+    static constexpr uint32_t kFormatVersion = 1;
+    
+    std::string path;
+    UniqueFd fd;
+    uint32_t dimension;
+    std::size_t sync_every;
+    std::size_t pending = 0;
+    std::size_t valid_records = 0;
+    std::vector<char> buffer;
+    
+    std::size_t recordSize() const { return (dimension + 1) * sizeof(double) + sizeof(uint64_t); }
+    
+    static uint64_t checksum(const char* data, std::size_t n) {
+        uint64_t h = 0xcbf29ce484222325ULL;
+        for (std::size_t i = 0; i < n; ++i) {
+            h = (h ^ static_cast<unsigned char>(data[i])) * 0x100000001b3ULL;
+        }
+        return h;
+    }
+    
+    void fail(const std::string& what) const {
+        throw std::runtime_error(what + " '" + path + "': " + std::strerror(errno));
+    }
+    
+    void writeAll(const char* data, std::size_t n) {
+        while (n > 0) {
+            ssize_t written = ::write(fd.get(), data, n);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                fail("write failed for");
+            }
+            data += written;
+            n -= static_cast<std::size_t>(written);
+        }
+    }
+    
+    // Scans records from the start, invoking callback on each intact one, and
+    // returns the byte offset just past the last intact record.
+    template <typename Callback>
+    off_t scan(Callback callback) const {
+        const std::size_t record_size = recordSize();
+        std::vector<char> chunk(record_size * 4096);
+        std::vector<double> x(dimension);
+        off_t offset = sizeof(FileHeader);
+        
+        for (;;) {
+            ssize_t n = pread(fd.get(), chunk.data(), chunk.size(), offset);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                fail("read failed for");
+            }
+            std::size_t whole = static_cast<std::size_t>(n) / record_size;
+            for (std::size_t i = 0; i < whole; ++i) {
+                const char* rec = chunk.data() + i * record_size;
+                uint64_t stored;
+                std::memcpy(&stored, rec + record_size - sizeof(uint64_t), sizeof(stored));
+                if (stored != checksum(rec, record_size - sizeof(uint64_t))) {
+                    return offset;
+                }
+                double y;
+                std::memcpy(x.data(), rec, dimension * sizeof(double));
+                std::memcpy(&y, rec + dimension * sizeof(double), sizeof(double));
+                callback(x.data(), y);
+                offset += static_cast<off_t>(record_size);
+            }
+            if (whole * record_size < chunk.size()) {
+                return offset;
+            }
+        }
+    }
+    
+public:
+    ObservationJournal(const std::string& journal_path, uint32_t dim, std::size_t sync_batch = 64)
+        : ObservationJournal(journal_path, dim, sync_batch, [](const double*, double) {}) {}
+    
+    // Opens the journal and hands every intact record to on_record in the
+    // same pass that finds and truncates a torn tail.
+    template <typename Callback>
+    ObservationJournal(const std::string& journal_path, uint32_t dim, std::size_t sync_batch, Callback on_record)
+        : path(journal_path), fd(::open(journal_path.c_str(), O_RDWR | O_CREAT, 0644)), dimension(dim),
+          sync_every(std::max<std::size_t>(1, sync_batch)) {
+        if (fd.get() < 0) {
+            fail("cannot open journal");
+        }
+        
+        FileHeader header{};
+        ssize_t n = pread(fd.get(), &header, sizeof(header), 0);
+        if (n == 0) {
+            header = {kMagic, kFormatVersion, dimension};
+            writeAll(reinterpret_cast<const char*>(&header), sizeof(header));
+            if (fdatasync(fd.get()) != 0) {
+                fail("fdatasync failed for");
+            }
+        } else if (n != static_cast<ssize_t>(sizeof(header)) || header.magic != kMagic ||
+                   header.format_version != kFormatVersion || header.dimension != dimension) {
+            throw std::runtime_error("journal '" + path + "' does not match dimension " +
+                                     std::to_string(dimension));
+        }
+        
+        off_t end = scan([&](const double* x, double y) {
+            on_record(x, y);
+            ++valid_records;
+        });
+        if (ftruncate(fd.get(), end) != 0 || lseek(fd.get(), end, SEEK_SET) < 0) {
+            fail("cannot position journal");
+        }
+        buffer.reserve(recordSize() * sync_every);
+    }
+    
+    ObservationJournal(const ObservationJournal&) = delete;
+    ObservationJournal& operator=(const ObservationJournal&) = delete;
+    
+    ~ObservationJournal() {
+        try {
+            sync();
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+        }
+    }
+    
+    void append(const double* x, double y) {
+        std::size_t start = buffer.size();
+        buffer.resize(start + recordSize());
+        char* rec = buffer.data() + start;
+        std::memcpy(rec, x, dimension * sizeof(double));
+        std::memcpy(rec + dimension * sizeof(double), &y, sizeof(double));
+        uint64_t sum = checksum(rec, recordSize() - sizeof(uint64_t));
+        std::memcpy(rec + recordSize() - sizeof(uint64_t), &sum, sizeof(sum));
+        
+        if (++pending >= sync_every) {
+            sync();
+        }
+    }
+    
+    void sync() {
+        if (buffer.empty()) {
+            return;
+        }
+        writeAll(buffer.data(), buffer.size());
+        if (fdatasync(fd.get()) != 0) {
+            fail("fdatasync failed for");
+        }
+        valid_records += pending;
+        buffer.clear();
+        pending = 0;
+    }
+    
+    std::size_t size() const { return valid_records + pending; }
+};
+
+constexpr std::size_t kDynamicDimension = 0;
+
+template <std::size_t D = kDynamicDimension>
+class BayesianOptimizer {
+public:
+    using Vector = std::array<double, D>;
+    
+    // Anytime proposal: candidates of kCandidates were scored before the
+    // deadline expired.
+    struct Proposal {
+        Vector x;
+        int candidates;
+        bool deadline_expired;
+    };
+    
+    static constexpr int kCandidates = 100;
+    
+private:
+    struct Point {
+        Vector x;
+        double y;
+    };
+    
+    std::vector<Point> observations;
+    std::array<std::pair<double, double>, D> bounds;
+    std::mt19937 rng;
+    std::size_t best_index = 0;
+    std::unique_ptr<ObservationJournal> journal;
+    
+    void record(const Vector& x, double y) {
+        observations.push_back({x, y});
+        if (y > observations[best_index].y) {
+            best_index = observations.size() - 1;
+        }
+    }
+    
+    template <std::size_t... I>
+    static double squaredDistance(const Vector& a, const Vector& b, std::index_sequence<I...>) {
+        return (0.0 + ... + ((a[I] - b[I]) * (a[I] - b[I])));
+    }
+    
+    template <std::size_t... I>
+    Vector samplePoint(std::index_sequence<I...>) {
+        return {{std::uniform_real_distribution<double>(bounds[I].first, bounds[I].second)(rng)...}};
+    }
+    
+    double expectedImprovement(const Vector& x, double best_y) const {
+        double mu = 0.0;
+        double sigma = 1.0;
+        
+        for (const auto& obs : observations) {
+            double dist = std::sqrt(squaredDistance(x, obs.x, std::make_index_sequence<D>{}));
+            double kernel = std::exp(-0.5 * dist);
+            mu += kernel * obs.y;
+            sigma *= (1.0 - kernel * 0.1);
+        }
+        
+        if (!observations.empty()) {
+            mu /= observations.size();
+            sigma = std::max(sigma, 0.01);
+        }
+        
+        double z = (mu - best_y) / sigma;
+        double phi = 0.5 * (1.0 + std::erf(z / std::sqrt(2.0)));
+        double pdf = std::exp(-0.5 * z * z) / std::sqrt(2.0 * M_PI);
+        
+        return (mu - best_y) * phi + sigma * pdf;
+    }
+    
+public:
+    BayesianOptimizer(const std::array<std::pair<double, double>, D>& b)
+        : bounds(b), rng(std::random_device{}()) {}
+    
+    Vector proposeNext() {
+        SearchDeadline unbounded;
+        return proposeWithin(unbounded).x;
+    }
+    
+    Proposal proposeWithin(SearchDeadline& deadline) {
+        if (observations.size() < 5) {
+            return {samplePoint(std::make_index_sequence<D>{}), 0, false};
+        }
+        
+        double best_y = observations[best_index].y;
+        
+        Vector best_x{};
+        double best_ei = -std::numeric_limits<double>::infinity();
+        
+        // Each candidate scores every observation, so poll the clock per candidate.
+        SearchDeadline per_candidate = deadline.withCheckInterval(1);
+        int i = 0;
+        for (; i < kCandidates; ++i) {
+            if (i > 0 && per_candidate.expired()) {
+                break;
+            }
+            Vector x = samplePoint(std::make_index_sequence<D>{});
+            double ei = expectedImprovement(x, best_y);
+            if (ei > best_ei) {
+                best_ei = ei;
+                best_x = x;
+            }
+        }
+        
+        if (i < kCandidates) {
+            deadline = per_candidate.withCheckInterval(deadline.checkInterval());
+        }
+        return {best_x, i, i < kCandidates};
+    }
+    
+    void update(const Vector& x, double y) {
+        record(x, y);
+        if (journal) {
+            journal->append(x.data(), y);
+        }
+    }
+    
+    // Replays any observations already in the journal, writes observations
+    // made before the attach to it, then logs every subsequent update().
+    // Returns the number of replayed observations.
+    std::size_t attachJournal(const std::string& path, std::size_t sync_every = 64) {
+        if (journal) {
+            throw std::logic_error("a journal is already attached");
+        }
+        const std::size_t existing = observations.size();
+        journal = std::make_unique<ObservationJournal>(path, static_cast<uint32_t>(D), sync_every,
+                                                       [this](const double* x, double y) {
+            Vector v;
+            std::copy(x, x + D, v.begin());
+            record(v, y);
+        });
+        std::size_t replayed = journal->size();
+        for (std::size_t i = 0; i < existing; ++i) {
+            journal->append(observations[i].x.data(), observations[i].y);
+        }
+        journal->sync();
+        return replayed;
+    }
+    
+    void syncJournal() {
+        if (journal) {
+            journal->sync();
+        }
+    }
+    
+    std::size_t size() const { return observations.size(); }
+    
+    std::pair<Vector, double> getBest() const {
+        if (observations.empty()) {
+            return {Vector{}, 0.0};
+        }
+        
+        return {observations[best_index].x, observations[best_index].y};
+    }
+};
+
+template <>
+class BayesianOptimizer<kDynamicDimension> {
+public:
+    struct Proposal {
+        std::vector<double> x;
+        int candidates;
+        bool deadline_expired;
+    };
+    
+    static constexpr int kCandidates = 100;
+    
+private:
+    struct Point {
+        std::vector<double> x;
+        double y;
+    };
+    
+    std::vector<Point> observations;
+    std::vector<std::pair<double, double>> bounds;
+    std::mt19937 rng;
+    std::size_t best_index = 0;
+    std::unique_ptr<ObservationJournal> journal;
+    
+    void record(const std::vector<double>& x, double y) {
+        observations.push_back({x, y});
+        if (y > observations[best_index].y) {
+            best_index = observations.size() - 1;
+        }
+    }
+    
+    double expectedImprovement(const std::vector<double>& x, double best_y) {
+        double mu = 0.0;
+        double sigma = 1.0;
+        
+        for (const auto& obs : observations) {
+            double dist = 0.0;
+            for (size_t i = 0; i < x.size(); ++i) {
+                dist += (x[i] - obs.x[i]) * (x[i] - obs.x[i]);
+            }
+            dist = std::sqrt(dist);
+            
+            double kernel = std::exp(-0.5 * dist);
+            mu += kernel * obs.y;
+            sigma *= (1.0 - kernel * 0.1);
+        }
+        
+        if (!observations.empty()) {
+            mu /= observations.size();
+            sigma = std::max(sigma, 0.01);
+        }
+        
+        double z = (mu - best_y) / sigma;
+        double phi = 0.5 * (1.0 + std::erf(z / std::sqrt(2.0)));
+        double pdf = std::exp(-0.5 * z * z) / std::sqrt(2.0 * M_PI);
+        
+        return (mu - best_y) * phi + sigma * pdf;
+    }
+    
+public:
+    BayesianOptimizer(const std::vector<std::pair<double, double>>& b)
+        : bounds(b), rng(std::random_device{}()) {}
+    
+    std::vector<double> proposeNext() {
+        SearchDeadline unbounded;
+        return proposeWithin(unbounded).x;
+    }
+    
+    Proposal proposeWithin(SearchDeadline& deadline) {
+        if (observations.size() < 5) {
+            std::vector<double> x;
+            for (const auto& bound : bounds) {
+                std::uniform_real_distribution<double> dist(bound.first, bound.second);
+                x.push_back(dist(rng));
+            }
+            return {x, 0, false};
+        }
+        
+        double best_y = observations[best_index].y;
+        
+        std::vector<double> best_x;
+        double best_ei = -std::numeric_limits<double>::infinity();
+        
+        // Each candidate scores every observation, so poll the clock per candidate.
+        SearchDeadline per_candidate = deadline.withCheckInterval(1);
+        int i = 0;
+        for (; i < kCandidates; ++i) {
+            if (i > 0 && per_candidate.expired()) {
+                break;
+            }
+            std::vector<double> x;
+            for (const auto& bound : bounds) {
+                std::uniform_real_distribution<double> dist(bound.first, bound.second);
+                x.push_back(dist(rng));
+            }
+            
+            double ei = expectedImprovement(x, best_y);
+            if (ei > best_ei) {
+                best_ei = ei;
+                best_x = x;
+            }
+        }
+        
+        if (i < kCandidates) {
+            deadline = per_candidate.withCheckInterval(deadline.checkInterval());
+        }
+        return {best_x, i, i < kCandidates};
+    }
+    
+    void update(const std::vector<double>& x, double y) {
+        if (x.size() != bounds.size()) {
+            throw std::invalid_argument("observation has " + std::to_string(x.size()) +
+                                        " dimensions, optimizer has " + std::to_string(bounds.size()));
+        }
+        record(x, y);
+        if (journal) {
+            journal->append(x.data(), y);
+        }
+    }
+    
+    std::size_t attachJournal(const std::string& path, std::size_t sync_every = 64) {
+        if (journal) {
+            throw std::logic_error("a journal is already attached");
+        }
+        const std::size_t dim = bounds.size();
+        const std::size_t existing = observations.size();
+        journal = std::make_unique<ObservationJournal>(path, static_cast<uint32_t>(dim), sync_every,
+                                                       [this, dim](const double* x, double y) {
+            record(std::vector<double>(x, x + dim), y);
+        });
+        std::size_t replayed = journal->size();
+        for (std::size_t i = 0; i < existing; ++i) {
+            journal->append(observations[i].x.data(), observations[i].y);
+        }
+        journal->sync();
+        return replayed;
+    }
+    
+    void syncJournal() {
+        if (journal) {
+            journal->sync();
+        }
+    }
+    
+    std::size_t size() const { return observations.size(); }
+    
+    std::pair<std::vector<double>, double> getBest() const {
+        if (observations.empty()) {
+            return {{}, 0.0};
+        }
+        
+        return {observations[best_index].x, observations[best_index].y};
+    }
+};
+
+class HugePageBuffer {
+private:
+    void* ptr = nullptr;
+    std::size_t length = 0;
+    bool explicit_huge_pages = false;
+    
+public:
+    static constexpr std::size_t kHugePageSize = 2 * 1024 * 1024;
+    static constexpr std::size_t kPageSize = 4096;
+    
+    HugePageBuffer() = default;
+    
+    HugePageBuffer(std::size_t bytes, bool use_huge_pages) {
+        std::size_t granule = use_huge_pages ? kHugePageSize : kPageSize;
+        length = std::max<std::size_t>(granule, (bytes + granule - 1) / granule * granule);
+        
+#ifdef MAP_HUGETLB
+        if (use_huge_pages) {
+            void* p = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (p != MAP_FAILED) {
+                ptr = p;
+                explicit_huge_pages = true;
+                return;
+            }
+        }
+#endif
+        void* p = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        ptr = p;
+#ifdef MADV_HUGEPAGE
+        if (use_huge_pages) {
+            madvise(ptr, length, MADV_HUGEPAGE);
+        }
+#endif
+    }
+    
+    HugePageBuffer(const HugePageBuffer&) = delete;
+    HugePageBuffer& operator=(const HugePageBuffer&) = delete;
+    
+    HugePageBuffer(HugePageBuffer&& other) noexcept
+        : ptr(other.ptr), length(other.length), explicit_huge_pages(other.explicit_huge_pages) {
+        other.ptr = nullptr;
+        other.length = 0;
+    }
+    
+    HugePageBuffer& operator=(HugePageBuffer&& other) noexcept {
+        if (this != &other) {
+            if (ptr) {
+                munmap(ptr, length);
+            }
+            ptr = other.ptr;
+            length = other.length;
+            explicit_huge_pages = other.explicit_huge_pages;
+            other.ptr = nullptr;
+            other.length = 0;
+        }
+        return *this;
+    }
+    
+    ~HugePageBuffer() {
+        if (ptr) {
+            munmap(ptr, length);
+        }
+    }
+    
+    void* data() const { return ptr; }
+    std::size_t size() const { return length; }
+    bool usesExplicitHugePages() const { return explicit_huge_pages; }
+};
+
+struct NumaNode {
+    int id;
+    std::vector<int> cpus;
+};
+
+class NumaTopology {
+private:
+    std::vector<NumaNode> nodes;
+    std::vector<int> cpu_to_node;
+    
+    // Kernel range list such as "0-3,8,10-11", used for both cpulist and
+    // the online node mask.
+    static std::vector<int> parseRangeList(const std::string& list) {
+        std::vector<int> cpus;
+        std::stringstream ss(list);
+        std::string range;
+        while (std::getline(ss, range, ',')) {
+            if (range.empty() || range == "\n") {
+                continue;
+            }
+            std::size_t dash = range.find('-');
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; ++cpu) {
+                cpus.push_back(cpu);
+            }
+        }
+        return cpus;
+    }
+    
+public:
+    // Node ids can be sparse (e.g. after memory hot-remove), so they come
+    // from the online mask rather than probing node0, node1, ...
+    NumaTopology() {
+        std::ifstream online("/sys/devices/system/node/online");
+        std::string node_list;
+        if (online) {
+            std::getline(online, node_list);
+        }
+        for (int id : parseRangeList(node_list)) {
+            std::ifstream in("/sys/devices/system/node/node" + std::to_string(id) + "/cpulist");
+            std::string list;
+            if (!in || !std::getline(in, list)) {
+                continue;
+            }
+            std::vector<int> cpus = parseRangeList(list);
+            if (!cpus.empty()) {
+                nodes.push_back({id, cpus});
+            }
+        }
+        
+        if (nodes.empty()) {
+            NumaNode node{0, {}};
+            unsigned n = std::max(1u, std::thread::hardware_concurrency());
+            for (unsigned cpu = 0; cpu < n; ++cpu) {
+                node.cpus.push_back(static_cast<int>(cpu));
+            }
+            nodes.push_back(node);
+        }
+        
+        for (const auto& node : nodes) {
+            for (int cpu : node.cpus) {
+                if (cpu >= static_cast<int>(cpu_to_node.size())) {
+                    cpu_to_node.resize(cpu + 1, -1);
+                }
+                cpu_to_node[cpu] = node.id;
+            }
+        }
+    }
+    
+    const std::vector<NumaNode>& getNodes() const { return nodes; }
+    
+    int nodeOfCpu(int cpu) const {
+        return (cpu >= 0 && cpu < static_cast<int>(cpu_to_node.size())) ? cpu_to_node[cpu] : -1;
+    }
+    
+    static int currentCpu() {
+#ifdef __linux__
+        return sched_getcpu();
+#else
+        return -1;
+#endif
+    }
+    
+    static bool pinCurrentThread(int cpu) {
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+        (void)cpu;
+        return false;
+#endif
+    }
+    
+    // Node holding each 4 KB page of [base, base + bytes), or -1 when unknown.
+    static std::vector<int> queryPageNodes(const void* base, std::size_t bytes) {
+        std::size_t pages = (bytes + HugePageBuffer::kPageSize - 1) / HugePageBuffer::kPageSize;
+        std::vector<int> status(pages, -1);
+#if defined(__linux__) && defined(SYS_move_pages)
+        std::vector<void*> addrs(pages);
+        for (std::size_t i = 0; i < pages; ++i) {
+            addrs[i] = static_cast<char*>(const_cast<void*>(base)) + i * HugePageBuffer::kPageSize;
+        }
+        if (syscall(SYS_move_pages, 0, pages, addrs.data(), nullptr, status.data(), 0) != 0) {
+            std::fill(status.begin(), status.end(), -1);
+        }
+        for (int& node : status) {
+            node = node < 0 ? -1 : node;
+        }
+#else
+        (void)base;
+#endif
+        return status;
+    }
+};
+
+// Catalog model records partitioned into one shard per NUMA node. Each shard
+// is first touched by a thread pinned to that node, so its pages are local.
+class NumaShardedModelTable {
+public:
+    struct Shard {
+        int node;
+        std::vector<int> cpus;
+        HugePageBuffer memory;
+        std::size_t first;
+        std::size_t count;
+        
+        ProductModelRecord* records() const { return static_cast<ProductModelRecord*>(memory.data()); }
+    };
+    
+private:
+    std::vector<Shard> shards;
+    std::size_t shard_size = 1;
+    std::size_t product_count = 0;
+    
+public:
+    NumaShardedModelTable(std::size_t products, const NumaTopology& topology, bool huge_pages,
+                          const std::function<void(std::size_t, ProductModelRecord&)>& init) {
+        const auto& nodes = topology.getNodes();
+        shard_size = std::max<std::size_t>(1, (products + nodes.size() - 1) / nodes.size());
+        product_count = products;
+        
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            std::size_t first = std::min(products, i * shard_size);
+            std::size_t count = std::min(products - first, shard_size);
+            shards.push_back({nodes[i].id, nodes[i].cpus,
+                              HugePageBuffer(count * sizeof(ProductModelRecord), huge_pages),
+                              first, count});
+        }
+        
+        std::vector<std::thread> threads;
+        for (auto& shard : shards) {
+            threads.emplace_back([&shard, &init]() {
+                NumaTopology::pinCurrentThread(shard.cpus.front());
+                ProductModelRecord* records = shard.records();
+                for (std::size_t i = 0; i < shard.count; ++i) {
+                    init(shard.first + i, records[i]);
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+    }
+    
+    std::vector<Shard>& getShards() { return shards; }
+    std::size_t size() const { return product_count; }
+    
+    ProductModelRecord& at(std::size_t index) {
+        if (index >= product_count) {
+            throw std::out_of_range("product " + std::to_string(index) + " outside sharded table");
+        }
+        Shard& shard = shards[index / shard_size];
+        return shard.records()[index - shard.first];
+    }
+    
+    std::size_t memoryUsage() const {
+        std::size_t bytes = 0;
+        for (const auto& shard : shards) {
+            bytes += shard.memory.size();
+        }
+        return bytes;
+    }
+};
+
+struct NumaBenchmarkResult {
+    double seconds;
+    double products_per_second;
+    uint64_t remote_accesses;
+    uint64_t total_accesses;
+    bool explicit_huge_pages;
+};
+
+class NumaCatalogBenchmark {
+private:
+    struct WorkSlice {
+        ProductModelRecord* records;
+        std::size_t count;
+        int pin_cpu;
+        std::vector<int> page_nodes;
+    };
+    
+    const NumaTopology& topology;
+    std::size_t products;
+    
+    static void initRecord(std::size_t index, ProductModelRecord& r) {
+        r.elasticity = -1.2f - 0.8f * static_cast<float>(index % 97) / 97.0f;
+        r.base_demand = 50.0f + static_cast<float>(index % 31);
+        r.alpha = 2.0f;
+        r.beta = 1.0f;
+        r.reference_price = 20.0f + static_cast<float>(index % 53);
+        r.version = 0;
+    }
+    
+    NumaBenchmarkResult run(std::vector<WorkSlice>& slices, bool huge_pages) const {
+        for (auto& slice : slices) {
+            slice.page_nodes = NumaTopology::queryPageNodes(slice.records,
+                                                            slice.count * sizeof(ProductModelRecord));
+        }
+        
+        std::atomic<uint64_t> remote{0};
+        std::atomic<uint64_t> total{0};
+        std::atomic<long long> checksum{0};
+        PriceOptimizer optimizer;
+        
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (auto& slice : slices) {
+            threads.emplace_back([&, slice_ptr = &slice]() {
+                const WorkSlice& w = *slice_ptr;
+                if (w.pin_cpu >= 0) {
+                    NumaTopology::pinCurrentThread(w.pin_cpu);
+                }
+                uint64_t local_remote = 0;
+                double sum = 0.0;
+                int node = -1;
+                for (std::size_t i = 0; i < w.count; ++i) {
+                    if ((i & 1023) == 0) {
+                        node = topology.nodeOfCpu(NumaTopology::currentCpu());
+                    }
+                    const ProductModelRecord& r = w.records[i];
+                    std::size_t page = i * sizeof(ProductModelRecord) / HugePageBuffer::kPageSize;
+                    int page_node = w.page_nodes[page];
+                    if (page_node >= 0 && node >= 0 && page_node != node) {
+                        ++local_remote;
+                    }
+                    double price = r.reference_price;
+                    OptimizationResult result = optimizer.optimizeModel(r, price * 0.6, price * 0.9,
+                                                                        price * 1.1, 400, 400);
+                    sum += result.optimal_price;
+                }
+                remote += local_remote;
+                total += w.count;
+                checksum += static_cast<long long>(sum);
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        
+        return {seconds, products / seconds, remote.load(), total.load(), huge_pages};
+    }
+    
+public:
+    NumaCatalogBenchmark(const NumaTopology& t, std::size_t n) : topology(t), products(n) {}
+    
+    // Baseline: one table first-touched by the calling thread, unpinned
+    // workers splitting the index range evenly.
+    NumaBenchmarkResult runInterleaved(std::size_t threads) const {
+        HugePageBuffer memory(products * sizeof(ProductModelRecord), false);
+        auto* records = static_cast<ProductModelRecord*>(memory.data());
+        for (std::size_t i = 0; i < products; ++i) {
+            initRecord(i, records[i]);
+        }
+        
+        std::vector<WorkSlice> slices;
+        std::size_t chunk = (products + threads - 1) / threads;
+        for (std::size_t t = 0; t < threads; ++t) {
+            std::size_t first = std::min(products, t * chunk);
+            slices.push_back({records + first, std::min(chunk, products - first), -1, {}});
+        }
+        return run(slices, false);
+    }
+    
+    NumaBenchmarkResult runNodeLocal() const {
+        NumaShardedModelTable table(products, topology, true, initRecord);
+        
+        std::vector<WorkSlice> slices;
+        bool explicit_huge = true;
+        for (auto& shard : table.getShards()) {
+            explicit_huge = explicit_huge && shard.memory.usesExplicitHugePages();
+            std::size_t workers = shard.cpus.size();
+            std::size_t chunk = (shard.count + workers - 1) / workers;
+            for (std::size_t w = 0; w < workers; ++w) {
+                std::size_t first = std::min(shard.count, w * chunk);
+                slices.push_back({shard.records() + first, std::min(chunk, shard.count - first),
+                                  shard.cpus[w], {}});
+            }
+        }
+        return run(slices, explicit_huge);
+    }
+};
+
+enum class PerfCounter : uint32_t {
+    Cycles,
+    Instructions,
+    LlcMisses,
+    Branches,
+    BranchMisses
+};
+
+constexpr std::size_t kPerfCounterCount = 5;
+
+struct PerfSample {
+    std::array<uint64_t, kPerfCounterCount> values{};
+    std::array<bool, kPerfCounterCount> available{};
+    double seconds = 0.0;
+    
+    bool has(PerfCounter c) const { return available[static_cast<std::size_t>(c)]; }
+    uint64_t value(PerfCounter c) const { return values[static_cast<std::size_t>(c)]; }
+    
+    double ipc() const {
+        return has(PerfCounter::Cycles) && has(PerfCounter::Instructions) && value(PerfCounter::Cycles)
+            ? static_cast<double>(value(PerfCounter::Instructions)) / value(PerfCounter::Cycles) : 0.0;
+    }
+    double branchMissRate() const {
+        return has(PerfCounter::Branches) && has(PerfCounter::BranchMisses) && value(PerfCounter::Branches)
+            ? static_cast<double>(value(PerfCounter::BranchMisses)) / value(PerfCounter::Branches) : 0.0;
+    }
+};
+
+// User-space hardware counters for the calling thread, opened as one
+// perf_event group so all counters cover the same interval. Counters the
+// kernel or hypervisor refuses are left unavailable rather than failing.
+class PerfCounterGroup {
+private:
+    std::array<int, kPerfCounterCount> fds;
+    std::array<int, kPerfCounterCount> slot;
+    int leader = -1;
+    int opened = 0;
+    std::string error;
+    std::chrono::steady_clock::time_point started;
+    
+    static int openCounter(uint64_t config, int group_fd) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = config;
+        attr.disabled = group_fd == -1 ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0));
+    }
+    
+public:
+    PerfCounterGroup() {
+        static const uint64_t configs[kPerfCounterCount] = {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_BRANCH_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_MISSES
+        };
+        fds.fill(-1);
+        slot.fill(-1);
+        for (std::size_t c = 0; c < kPerfCounterCount; ++c) {
+            int fd = openCounter(configs[c], leader);
+            if (fd < 0) {
+                if (error.empty()) {
+                    error = std::strerror(errno);
+                }
+                continue;
+            }
+            if (leader == -1) {
+                leader = fd;
+            }
+            fds[c] = fd;
+            slot[c] = opened++;
+        }
+    }
+    
+    ~PerfCounterGroup() {
+        for (int fd : fds) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+    }
+    
+    PerfCounterGroup(const PerfCounterGroup&) = delete;
+    PerfCounterGroup& operator=(const PerfCounterGroup&) = delete;
+    
+    bool available() const { return leader >= 0; }
+    const std::string& lastError() const { return error; }
+    
+    void start() {
+        if (leader >= 0) {
+            ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+        started = std::chrono::steady_clock::now();
+    }
+    
+    // Counts are scaled by enabled/running time when the PMU multiplexed
+    // the group.
+    PerfSample stop() {
+        PerfSample sample;
+        sample.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        if (leader < 0) {
+            return sample;
+        }
+        ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        
+        std::array<uint64_t, 3 + kPerfCounterCount> buf{};
+        ssize_t n = read(leader, buf.data(), sizeof(buf));
+        if (n < static_cast<ssize_t>(3 * sizeof(uint64_t)) || buf[2] == 0) {
+            return sample;
+        }
+        double scale = static_cast<double>(buf[1]) / buf[2];
+        for (std::size_t c = 0; c < kPerfCounterCount; ++c) {
+            if (slot[c] >= 0 && static_cast<uint64_t>(slot[c]) < buf[0]) {
+                sample.values[c] = static_cast<uint64_t>(buf[3 + slot[c]] * scale);
+                sample.available[c] = true;
+            }
+        }
+        return sample;
+    }
+};
+
+// Trained model records in a POSIX shared-memory segment. One process
+// publishes; any number of local processes map the same pages read-only.
+// The layout is offset-based so every process can map it at any address,
+// and each slot carries its own seqlock so readers never block the writer.
+// A slot whose sequence is still 0 has never been published.
+class SharedModelSegment {
+public:
+    struct Header {
+        uint64_t magic;
+        uint32_t layout_version;
+        uint32_t slot_size;
+        uint64_t capacity;
+        uint64_t slots_offset;
+        std::atomic<uint64_t> generation;
+        std::atomic<uint64_t> published;
+    };
+    
+    struct Slot {
+        std::atomic<uint32_t> sequence;
+        ProductModelRecord record;
+    };
+    
+    static constexpr uint64_t kMagic = 0x50524d4f44454c31ULL;
+    static constexpr uint32_t kLayoutVersion = 2;
+    
+private:
+    std::string name;
+    void* base = nullptr;
+    std::size_t length = 0;
+    bool writable = false;
+    
+    Header* header() const { return static_cast<Header*>(base); }
+    
+    Slot* slots() const {
+        return reinterpret_cast<Slot*>(static_cast<char*>(base) + header()->slots_offset);
+    }
+    
+    static std::size_t segmentSize(std::size_t capacity) {
+        std::size_t slots_offset = (sizeof(Header) + 63) / 64 * 64;
+        return slots_offset + capacity * sizeof(Slot);
+    }
+    
+    SharedModelSegment(const std::string& n, void* b, std::size_t len, bool w)
+        : name(n), base(b), length(len), writable(w) {}
+    
+    static void fail(const std::string& what, const std::string& segment) {
+        throw std::runtime_error(what + " '" + segment + "': " + std::strerror(errno));
+    }
+    
+public:
+    // Replaces any existing segment of that name with a fresh one. Readers
+    // that still map the old segment keep its pages until they unmap; the
+    // old object is never resized under them.
+    static SharedModelSegment create(const std::string& segment_name, std::size_t capacity) {
+        shm_unlink(segment_name.c_str());
+        int fd = shm_open(segment_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd < 0) {
+            fail("shm_open failed for", segment_name);
+        }
+        std::size_t len = segmentSize(capacity);
+        if (ftruncate(fd, static_cast<off_t>(len)) != 0) {
+            close(fd);
+            fail("ftruncate failed for", segment_name);
+        }
+        void* p = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (p == MAP_FAILED) {
+            fail("mmap failed for", segment_name);
+        }
+        
+        auto* h = static_cast<Header*>(p);
+        h->magic = 0;
+        h->layout_version = kLayoutVersion;
+        h->slot_size = sizeof(Slot);
+        h->capacity = capacity;
+        h->slots_offset = (sizeof(Header) + 63) / 64 * 64;
+        h->generation.store(0, std::memory_order_relaxed);
+        h->published.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        h->magic = kMagic;
+        
+        return SharedModelSegment(segment_name, p, len, true);
+    }
+    
+    static SharedModelSegment open(const std::string& segment_name) {
+        int fd = shm_open(segment_name.c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            fail("shm_open failed for", segment_name);
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            fail("fstat failed for", segment_name);
+        }
+        std::size_t len = static_cast<std::size_t>(st.st_size);
+        void* p = mmap(nullptr, len, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (p == MAP_FAILED) {
+            fail("mmap failed for", segment_name);
+        }
+        
+        SharedModelSegment segment(segment_name, p, len, false);
+        const Header* h = segment.header();
+        if (len < sizeof(Header) || h->magic != kMagic || h->layout_version != kLayoutVersion ||
+            h->slot_size != sizeof(Slot) || segmentSize(h->capacity) > len) {
+            throw std::runtime_error("incompatible model segment '" + segment_name + "'");
+        }
+        return segment;
+    }
+    
+    static void unlink(const std::string& segment_name) {
+        shm_unlink(segment_name.c_str());
+    }
+    
+    SharedModelSegment(const SharedModelSegment&) = delete;
+    SharedModelSegment& operator=(const SharedModelSegment&) = delete;
+    
+    SharedModelSegment(SharedModelSegment&& other) noexcept
+        : name(std::move(other.name)), base(other.base), length(other.length), writable(other.writable) {
+        other.base = nullptr;
+        other.length = 0;
+    }
+    
+    ~SharedModelSegment() {
+        if (base) {
+            munmap(base, length);
+        }
+    }
+    
+    void publish(uint32_t index, const ProductModelRecord& record) {
+        if (!writable || index >= header()->capacity) {
+            throw std::out_of_range("cannot publish model slot " + std::to_string(index));
+        }
+        Slot& slot = slots()[index];
+        uint32_t seq = slot.sequence.load(std::memory_order_relaxed);
+        slot.sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&slot.record, &record, sizeof(record));
+        uint32_t next = seq + 2;
+        slot.sequence.store(next != 0 ? next : 2, std::memory_order_release);
+        
+        if (seq == 0) {
+            header()->published.fetch_add(1, std::memory_order_release);
+        }
+    }
+    
+    void publishTable(const ProductModelTable& table) {
+        Header* h = header();
+        h->generation.fetch_add(1, std::memory_order_acq_rel);
+        std::size_t n = std::min<std::size_t>(table.size(), h->capacity);
+        for (std::size_t i = 0; i < n; ++i) {
+            publish(static_cast<uint32_t>(i), table[static_cast<uint32_t>(i)]);
+        }
+        h->generation.fetch_add(1, std::memory_order_acq_rel);
+    }
+    
+    // False for a slot outside the segment or never published.
+    bool read(uint32_t index, ProductModelRecord& out) const {
+        if (index >= header()->capacity) {
+            return false;
+        }
+        const Slot& slot = slots()[index];
+        for (;;) {
+            uint32_t before = slot.sequence.load(std::memory_order_acquire);
+            if (before == 0) {
+                return false;
+            }
+            if (before & 1u) {
+                std::this_thread::yield();
+                continue;
+            }
+            std::memcpy(&out, &slot.record, sizeof(out));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) == before) {
+                return true;
+            }
+        }
+    }
+    
+    double predictDemand(uint32_t index, double new_price) const {
+        ProductModelRecord r;
+        if (!read(index, r)) {
+            return 0.0;
+        }
+        if (r.reference_price <= 0.0f) {
+            return r.base_demand;
+        }
+        return r.base_demand * std::pow(new_price / r.reference_price, static_cast<double>(r.elasticity));
+    }
+    
+    // Odd while a bulk publication is in progress.
+    uint64_t generation() const { return header()->generation.load(std::memory_order_acquire); }
+    // Number of distinct slots published at least once.
+    std::size_t size() const { return header()->published.load(std::memory_order_acquire); }
+    std::size_t capacity() const { return header()->capacity; }
+    const std::string& getName() const { return name; }
+};
+
+// Self-describing columnar batch format. A file holds a schema, a sequence of
+// chunks whose column buffers are 64-byte aligned, and a trailing chunk index:
+//
+//   [FileHeader][ColumnSpec x columns] ([ChunkHeader][column 0]...[column n-1])*
+//   [ChunkIndexEntry x chunks][FileFooter]
+//
+// Readers mmap the file and hand out typed pointers straight into the mapping,
+// so projecting a subset of columns only touches those columns' pages.
+enum class ColumnType : uint32_t {
+    Float64 = 1,
+    Int32 = 2
+};
+
+struct ColumnSpec {
+    char name[32];
+    ColumnType type;
+    uint32_t reserved;
+    
+    static ColumnSpec make(const std::string& column_name, ColumnType column_type) {
+        ColumnSpec spec{};
+        std::strncpy(spec.name, column_name.c_str(), sizeof(spec.name) - 1);
+        spec.type = column_type;
+        return spec;
+    }
+    
+    std::size_t width() const { return type == ColumnType::Float64 ? sizeof(double) : sizeof(int32_t); }
+};
+
+class ColumnarFormat {
+public:
+    struct FileHeader {
+        char magic[8];
+        uint32_t format_version;
+        uint32_t column_count;
+    };
+    
+    struct ChunkHeader {
+        uint64_t magic;
+        uint64_t rows;
+    };
+    
+    struct ChunkIndexEntry {
+        uint64_t offset;
+        uint64_t rows;
+    };
+    
+    struct FileFooter {
+        uint64_t chunk_count;
+        uint64_t index_offset;
+        uint64_t total_rows;
+        char magic[8];
+    };
+    
+    static constexpr char kFileMagic[8] = {'P', 'R', 'C', 'O', 'L', '0', '0', '1'};
+    static constexpr char kFooterMagic[8] = {'P', 'R', 'C', 'O', 'L', 'E', 'N', 'D'};
+    static constexpr uint64_t kChunkMagic = 0x4b4e4843504c4f43ULL;
+    static constexpr uint32_t kFormatVersion = 1;
+    static constexpr std::size_t kAlignment = 64;
+    
+    static std::size_t align(std::size_t n) { return (n + kAlignment - 1) / kAlignment * kAlignment; }
+};
+
+class ColumnarWriter {
+private:
+    std::string path;
+    std::ofstream out;
+    std::vector<ColumnSpec> schema;
+    std::vector<ColumnarFormat::ChunkIndexEntry> chunks;
+    uint64_t offset = 0;
+    uint64_t total_rows = 0;
+    bool closed = false;
+    
+    void write(const void* data, std::size_t n) {
+        out.write(static_cast<const char*>(data), static_cast<std::streamsize>(n));
+        offset += n;
+    }
+    
+    void pad() {
+        static const char zeros[ColumnarFormat::kAlignment] = {};
+        std::size_t aligned = ColumnarFormat::align(offset);
+        write(zeros, aligned - offset);
+    }
+    
+public:
+    ColumnarWriter(const std::string& file_path, const std::vector<ColumnSpec>& columns)
+        : path(file_path), out(file_path, std::ios::binary | std::ios::trunc), schema(columns) {
+        if (!out) {
+            throw std::runtime_error("cannot create columnar file '" + path + "'");
+        }
+        ColumnarFormat::FileHeader header{};
+        std::memcpy(header.magic, ColumnarFormat::kFileMagic, sizeof(header.magic));
+        header.format_version = ColumnarFormat::kFormatVersion;
+        header.column_count = static_cast<uint32_t>(schema.size());
+        write(&header, sizeof(header));
+        write(schema.data(), schema.size() * sizeof(ColumnSpec));
+        pad();
+    }
+    
+    ~ColumnarWriter() {
+        if (!closed) {
+            try {
+                close();
+            } catch (const std::exception& e) {
+                std::cerr << e.what() << std::endl;
+            }
+        }
+    }
+    
+    // columns[i] points at rows values of schema[i]'s type.
+    void writeChunk(std::size_t rows, const std::vector<const void*>& columns) {
+        if (columns.size() != schema.size()) {
+            throw std::invalid_argument("chunk has " + std::to_string(columns.size()) +
+                                        " columns, schema has " + std::to_string(schema.size()));
+        }
+        chunks.push_back({offset, rows});
+        ColumnarFormat::ChunkHeader header{ColumnarFormat::kChunkMagic, rows};
+        write(&header, sizeof(header));
+        pad();
+        for (std::size_t c = 0; c < schema.size(); ++c) {
+            write(columns[c], rows * schema[c].width());
+            pad();
+        }
+        total_rows += rows;
+    }
+    
+    void close() {
+        if (closed) {
+            return;
+        }
+        closed = true;
+        uint64_t index_offset = offset;
+        write(chunks.data(), chunks.size() * sizeof(ColumnarFormat::ChunkIndexEntry));
+        ColumnarFormat::FileFooter footer{chunks.size(), index_offset, total_rows, {}};
+        std::memcpy(footer.magic, ColumnarFormat::kFooterMagic, sizeof(footer.magic));
+        write(&footer, sizeof(footer));
+        out.close();
+        if (!out) {
+            throw std::runtime_error("failed writing columnar file '" + path + "'");
+        }
+    }
+};
+
+class ColumnarReader {
+private:
+    std::string path;
+    const char* base = nullptr;
+    std::size_t length = 0;
+    std::vector<ColumnSpec> schema;
+    const ColumnarFormat::ChunkIndexEntry* index = nullptr;
+    ColumnarFormat::FileFooter footer{};
+    
+    void invalid(const std::string& why) {
+        if (base) {
+            munmap(const_cast<char*>(base), length);
+            base = nullptr;
+        }
+        throw std::runtime_error("invalid columnar file '" + path + "': " + why);
+    }
+    
+public:
+    explicit ColumnarReader(const std::string& file_path) : path(file_path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("cannot open '" + path + "': " + std::strerror(errno));
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("cannot stat '" + path + "': " + std::strerror(errno));
+        }
+        length = static_cast<std::size_t>(st.st_size);
+        if (length < sizeof(ColumnarFormat::FileHeader) + sizeof(ColumnarFormat::FileFooter)) {
+            ::close(fd);
+            invalid("file too small");
+        }
+        void* p = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            throw std::runtime_error("cannot map '" + path + "': " + std::strerror(errno));
+        }
+        base = static_cast<const char*>(p);
+        
+        ColumnarFormat::FileHeader header;
+        std::memcpy(&header, base, sizeof(header));
+        std::memcpy(&footer, base + length - sizeof(footer), sizeof(footer));
+        if (std::memcmp(header.magic, ColumnarFormat::kFileMagic, sizeof(header.magic)) != 0 ||
+            std::memcmp(footer.magic, ColumnarFormat::kFooterMagic, sizeof(footer.magic)) != 0) {
+            invalid("bad magic");
+        }
+        if (header.format_version != ColumnarFormat::kFormatVersion) {
+            invalid("unsupported version " + std::to_string(header.format_version));
+        }
+        
+        // Sizes come from the file, so every range check subtracts from a
+        // known-valid bound instead of adding untrusted values.
+        const char* specs = base + sizeof(header);
+        if (header.column_count > (length - sizeof(header) - sizeof(footer)) / sizeof(ColumnSpec)) {
+            invalid("schema out of range");
+        }
+        schema.resize(header.column_count);
+        std::memcpy(schema.data(), specs, header.column_count * sizeof(ColumnSpec));
+        for (const auto& spec : schema) {
+            if (strnlen(spec.name, sizeof(spec.name)) == sizeof(spec.name)) {
+                invalid("unterminated column name");
+            }
+        }
+        
+        uint64_t index_space = length - sizeof(footer);
+        if (footer.index_offset > index_space ||
+            footer.chunk_count > (index_space - footer.index_offset) / sizeof(ColumnarFormat::ChunkIndexEntry) ||
+            footer.index_offset % alignof(ColumnarFormat::ChunkIndexEntry)) {
+            invalid("chunk index out of range");
+        }
+        index = reinterpret_cast<const ColumnarFormat::ChunkIndexEntry*>(base + footer.index_offset);
+        uint64_t data_end = footer.index_offset;
+        uint64_t row_sum = 0;
+        for (std::size_t c = 0; c < footer.chunk_count; ++c) {
+            bool in_range = index[c].offset <= data_end &&
+                            sizeof(ColumnarFormat::ChunkHeader) <= data_end - index[c].offset;
+            if (in_range) {
+                ColumnarFormat::ChunkHeader chunk;
+                std::memcpy(&chunk, base + index[c].offset, sizeof(chunk));
+                if (chunk.magic != ColumnarFormat::kChunkMagic || chunk.rows != index[c].rows) {
+                    invalid("chunk " + std::to_string(c) + " header mismatch");
+                }
+            }
+            if (index[c].rows > footer.total_rows - row_sum) {
+                invalid("row count mismatch");
+            }
+            row_sum += index[c].rows;
+            uint64_t end = in_range ? ColumnarFormat::align(index[c].offset + sizeof(ColumnarFormat::ChunkHeader)) : 0;
+            for (std::size_t k = 0; in_range && k < schema.size(); ++k) {
+                in_range = end <= data_end && index[c].rows <= (data_end - end) / schema[k].width();
+                if (in_range) {
+                    end = ColumnarFormat::align(end + index[c].rows * schema[k].width());
+                }
+            }
+            if (!in_range || end > data_end) {
+                invalid("chunk " + std::to_string(c) + " out of range");
+            }
+        }
+        if (row_sum != footer.total_rows) {
+            invalid("row count mismatch");
+        }
+        madvise(const_cast<char*>(base), length, MADV_SEQUENTIAL);
+    }
+    
+    ColumnarReader(const ColumnarReader&) = delete;
+    ColumnarReader& operator=(const ColumnarReader&) = delete;
+    
+    ~ColumnarReader() {
+        if (base) {
+            munmap(const_cast<char*>(base), length);
+        }
+    }
+    
+    const std::vector<ColumnSpec>& getSchema() const { return schema; }
+    std::size_t chunkCount() const { return footer.chunk_count; }
+    std::size_t chunkRows(std::size_t chunk) const { return index[chunk].rows; }
+    std::size_t totalRows() const { return footer.total_rows; }
+    
+    int columnIndex(const std::string& name) const {
+        for (std::size_t c = 0; c < schema.size(); ++c) {
+            if (name == std::string_view(schema[c].name, strnlen(schema[c].name, sizeof(schema[c].name)))) {
+                return static_cast<int>(c);
+            }
+        }
+        return -1;
+    }
+    
+    template <typename T>
+    const T* column(std::size_t chunk, int column_index) const {
+        const ColumnSpec& spec = schema.at(column_index);
+        ColumnType expected = std::is_same<T, double>::value ? ColumnType::Float64 : ColumnType::Int32;
+        if (spec.type != expected) {
+            throw std::invalid_argument(std::string("column '") + spec.name + "' has a different type");
+        }
+        std::size_t offset = ColumnarFormat::align(index[chunk].offset + sizeof(ColumnarFormat::ChunkHeader));
+        for (int c = 0; c < column_index; ++c) {
+            offset = ColumnarFormat::align(offset + index[chunk].rows * schema[c].width());
+        }
+        return reinterpret_cast<const T*>(base + offset);
+    }
+    
+    template <typename T>
+    const T* column(std::size_t chunk, const std::string& name) const {
+        int c = columnIndex(name);
+        return c < 0 ? nullptr : column<T>(chunk, c);
+    }
+};
+
+struct SyntheticCatalogConfig {
+    uint64_t seed = 42;
+    int days = 30;
+    double min_price = 2.0;
+    double max_price = 500.0;
+    double competitor_volatility = 0.03;
+    double competitor_reversion = 0.1;
+    double promotion_rate = 0.08;
+    double restock_threshold = 0.3;
+    int restock_lead_days = 3;
+};
+
+struct SyntheticProduct {
+    double reference_price;
+    double cost;
+    double elasticity;
+    double alpha;
+    double beta;
+    double demand_rate;
+    double competitor_spread;
+    int32_t inventory_level;
+    int32_t target_inventory;
+};
+
+// Deterministic synthetic catalogs for load and soak tests. Every product is
+// derived from its own splitmix stream keyed by (seed, index), so any product
+// can be regenerated alone and output does not depend on chunking. Products
+// draw from a handful of categories with distinct elasticity levels; the
+// purchase rate is a draw from the product's Gamma prior, competitor prices
+// follow a mean-reverting log random walk and stock depletes with sales and
+// restocks to target after a lead time.
+class SyntheticCatalogGenerator {
+private:
+    static constexpr int kCategories = 8;
+    static constexpr double kCategoryElasticity[kCategories] = {-0.6, -1.1, -1.4, -1.8, -2.2, -2.7, -3.2, -4.0};
+    
+    SyntheticCatalogConfig config;
+    
+    uint64_t productSeed(uint64_t index) const { return SplitMix64::mix(config.seed, index); }
+    
+public:
+    explicit SyntheticCatalogGenerator(const SyntheticCatalogConfig& cfg = SyntheticCatalogConfig())
+        : config(cfg) {}
+    
+    const SyntheticCatalogConfig& getConfig() const { return config; }
+    
+    SyntheticProduct product(uint64_t index) const {
+        SplitMix64 rng(productSeed(index));
+        SyntheticProduct p;
+        p.reference_price = config.min_price * std::pow(config.max_price / config.min_price, rng.uniform());
+        p.reference_price = std::round(p.reference_price * 100.0) / 100.0;
+        p.cost = p.reference_price * rng.uniform(0.35, 0.75);
+        int category = static_cast<int>(rng.next() % kCategories);
+        p.elasticity = std::min(-0.2, kCategoryElasticity[category] + 0.25 * rng.normal());
+        p.alpha = rng.uniform(0.5, 8.0);
+        p.beta = rng.uniform(0.05, 1.5);
+        p.demand_rate = rng.gamma(p.alpha) / p.beta;
+        p.competitor_spread = rng.uniform(0.03, 0.25);
+        p.target_inventory = static_cast<int32_t>(std::ceil(p.alpha / p.beta * 14.0)) + 10;
+        p.inventory_level = static_cast<int32_t>(p.target_inventory * rng.uniform(0.4, 1.6));
+        return p;
+    }
+    
+    // Calls emit(const BacktestEvent&) for one product's history in time
+    // order: a competitor quote, a stock level and the day's sales.
+    template <typename Emit>
+    void events(uint32_t index, Emit emit) const {
+        SyntheticProduct p = product(index);
+        SplitMix64 rng(productSeed(index) ^ 0x5bd1e9955bd1e995ULL);
+        double log_reference = std::log(p.reference_price);
+        double log_competitor = log_reference + config.competitor_volatility * rng.normal();
+        int64_t inventory = p.inventory_level;
+        int restock_day = -1;
+        
+        for (int day = 0; day < config.days; ++day) {
+            int64_t t = static_cast<int64_t>(day) * 86400;
+            log_competitor += config.competitor_volatility * rng.normal() -
+                              config.competitor_reversion * (log_competitor - log_reference);
+            emit(BacktestEvent{t, index, BacktestEventType::CompetitorPrice, std::exp(log_competitor), 0.0});
+            
+            if (day == restock_day) {
+                inventory = std::max<int64_t>(inventory, p.target_inventory);
+                restock_day = -1;
+            }
+            emit(BacktestEvent{t + 3600, index, BacktestEventType::Inventory, 0.0, static_cast<double>(inventory)});
+            
+            double price = rng.uniform() < config.promotion_rate
+                ? p.reference_price * rng.uniform(0.7, 0.9)
+                : p.reference_price * rng.uniform(0.98, 1.02);
+            double mean = p.demand_rate * std::pow(price / p.reference_price, p.elasticity);
+            int64_t sold = std::min<int64_t>(rng.poisson(mean), inventory);
+            inventory -= sold;
+            emit(BacktestEvent{t + 7200, index, BacktestEventType::Sale, price, static_cast<double>(sold)});
+            
+            if (restock_day < 0 && inventory < config.restock_threshold * p.target_inventory) {
+                restock_day = day + config.restock_lead_days;
+            }
+        }
+    }
+    
+    // Same schema as --batch input plus the Gamma prior, so the file feeds
+    // runColumnarBatch directly.
+    std::size_t writeCatalog(const std::string& path, std::size_t products, std::size_t chunk_rows = 65536) const {
+        ColumnarWriter writer(path, {
+            ColumnSpec::make("current_price", ColumnType::Float64),
+            ColumnSpec::make("cost", ColumnType::Float64),
+            ColumnSpec::make("elasticity", ColumnType::Float64),
+            ColumnSpec::make("base_demand", ColumnType::Float64),
+            ColumnSpec::make("min_competitor", ColumnType::Float64),
+            ColumnSpec::make("max_competitor", ColumnType::Float64),
+            ColumnSpec::make("inventory_level", ColumnType::Int32),
+            ColumnSpec::make("target_inventory", ColumnType::Int32),
+            ColumnSpec::make("demand_alpha", ColumnType::Float64),
+            ColumnSpec::make("demand_beta", ColumnType::Float64),
+        });
+        std::vector<double> price, cost, elasticity, base, min_comp, max_comp, alpha, beta;
+        std::vector<int32_t> inventory, target;
+        for (std::size_t first = 0; first < products; first += chunk_rows) {
+            std::size_t n = std::min(chunk_rows, products - first);
+            for (auto* v : {&price, &cost, &elasticity, &base, &min_comp, &max_comp, &alpha, &beta}) {
+                v->resize(n);
+            }
+            inventory.resize(n);
+            target.resize(n);
+            for (std::size_t i = 0; i < n; ++i) {
+                SyntheticProduct p = product(first + i);
+                price[i] = p.reference_price;
+                cost[i] = p.cost;
+                elasticity[i] = p.elasticity;
+                base[i] = p.alpha / p.beta;
+                min_comp[i] = p.reference_price * (1.0 - p.competitor_spread);
+                max_comp[i] = p.reference_price * (1.0 + p.competitor_spread);
+                inventory[i] = p.inventory_level;
+                target[i] = p.target_inventory;
+                alpha[i] = p.alpha;
+                beta[i] = p.beta;
+            }
+            writer.writeChunk(n, {price.data(), cost.data(), elasticity.data(), base.data(), min_comp.data(),
+                                  max_comp.data(), inventory.data(), target.data(), alpha.data(), beta.data()});
+        }
+        writer.close();
+        return products;
+    }
+};
+
+// Flat binary log of BacktestEvent records:
+//   [Header]["PREVT001", version, record size, count] [Record x count]
+// Records are fixed 32-byte little-endian structs written in product order.
+class EventLogFormat {
+public:
+    struct Header {
+        char magic[8];
+        uint32_t format_version;
+        uint32_t record_size;
+        uint64_t count;
+    };
+    
+    struct Record {
+        int64_t timestamp;
+        uint32_t product;
+        uint8_t type;
+        uint8_t reserved[3];
+        double price;
+        double quantity;
+    };
+    
+    static constexpr char kMagic[8] = {'P', 'R', 'E', 'V', 'T', '0', '0', '1'};
+    static constexpr uint32_t kFormatVersion = 1;
+};
+
+static_assert(sizeof(EventLogFormat::Record) == 32, "event log records are 32 bytes on disk");
+
+class EventLogWriter {
+private:
+    std::string path;
+    std::ofstream out;
+    std::vector<EventLogFormat::Record> buffer;
+    uint64_t count = 0;
+    bool closed = false;
+    
+    void drain() {
+        out.write(reinterpret_cast<const char*>(buffer.data()),
+                  static_cast<std::streamsize>(buffer.size() * sizeof(EventLogFormat::Record)));
+        buffer.clear();
+    }
+    
+    EventLogFormat::Header header() const {
+        EventLogFormat::Header h{};
+        std::memcpy(h.magic, EventLogFormat::kMagic, sizeof(h.magic));
+        h.format_version = EventLogFormat::kFormatVersion;
+        h.record_size = sizeof(EventLogFormat::Record);
+        h.count = count;
+        return h;
+    }
+    
+public:
+    explicit EventLogWriter(const std::string& file_path)
+        : path(file_path), out(file_path, std::ios::binary | std::ios::trunc) {
+        if (!out) {
+            throw std::runtime_error("cannot create event log '" + path + "'");
+        }
+        EventLogFormat::Header h = header();
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        buffer.reserve(1 << 15);
+    }
+    
+    ~EventLogWriter() {
+        if (!closed) {
+            try {
+                close();
+            } catch (const std::exception& e) {
+                std::cerr << e.what() << std::endl;
+            }
+        }
+    }
+    
+    void append(const BacktestEvent& e) {
+        EventLogFormat::Record r{};
+        r.timestamp = e.timestamp;
+        r.product = e.product;
+        r.type = static_cast<uint8_t>(e.type);
+        r.price = e.price;
+        r.quantity = e.quantity;
+        buffer.push_back(r);
+        ++count;
+        if (buffer.size() == buffer.capacity()) {
+            drain();
+        }
+    }
+    
+    void close() {
+        if (closed) {
+            return;
+        }
+        closed = true;
+        drain();
+        EventLogFormat::Header h = header();
+        out.seekp(0);
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        out.close();
+        if (!out) {
+            throw std::runtime_error("failed writing event log '" + path + "'");
+        }
+    }
+    
+    uint64_t size() const { return count; }
+};
+
+class EventLogReader {
+public:
+    static std::vector<BacktestEvent> readAll(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error("cannot open '" + path + "': " + std::strerror(errno));
+        }
+        EventLogFormat::Header h;
+        if (!in.read(reinterpret_cast<char*>(&h), sizeof(h)) ||
+            std::memcmp(h.magic, EventLogFormat::kMagic, sizeof(h.magic)) != 0 ||
+            h.format_version != EventLogFormat::kFormatVersion ||
+            h.record_size != sizeof(EventLogFormat::Record)) {
+            throw std::runtime_error("invalid event log '" + path + "'");
+        }
+        // The header count is untrusted until it fits in the file.
+        in.seekg(0, std::ios::end);
+        uint64_t payload = static_cast<uint64_t>(in.tellg()) - sizeof(h);
+        in.seekg(sizeof(h), std::ios::beg);
+        if (!in || h.count > payload / sizeof(EventLogFormat::Record)) {
+            throw std::runtime_error("invalid event log '" + path + "': truncated");
+        }
+        std::vector<BacktestEvent> events;
+        events.reserve(h.count);
+        std::vector<EventLogFormat::Record> chunk(1 << 15);
+        uint64_t remaining = h.count;
+        while (remaining > 0) {
+            std::size_t n = static_cast<std::size_t>(std::min<uint64_t>(remaining, chunk.size()));
+            if (!in.read(reinterpret_cast<char*>(chunk.data()),
+                         static_cast<std::streamsize>(n * sizeof(EventLogFormat::Record)))) {
+                throw std::runtime_error("invalid event log '" + path + "': truncated");
+            }
+            for (std::size_t i = 0; i < n; ++i) {
+                const auto& r = chunk[i];
+                if (r.type > static_cast<uint8_t>(BacktestEventType::Inventory)) {
+                    throw std::runtime_error("invalid event log '" + path + "': bad event type");
+                }
+                events.push_back({r.timestamp, r.product, static_cast<BacktestEventType>(r.type),
+                                  r.price, r.quantity});
+            }
+            remaining -= n;
+        }
+        return events;
+    }
+};
+
+struct BenchmarkSeries {
+    std::string name;
+    std::vector<double> ns_per_op;
+    
+    double median() const {
+        if (ns_per_op.empty()) {
+            return 0.0;
+        }
+        std::vector<double> sorted(ns_per_op);
+        std::sort(sorted.begin(), sorted.end());
+        std::size_t mid = sorted.size() / 2;
+        return sorted.size() % 2 ? sorted[mid] : 0.5 * (sorted[mid - 1] + sorted[mid]);
+    }
+};
+
+struct BenchmarkComparison {
+    std::string name;
+    double baseline_median;
+    double current_median;
+    double change_percent;
+    double p_value;
+    bool regression;
+};
+
+// Saves benchmark samples as JSON and compares fresh runs against them. A
+// benchmark regresses when a one-sided Mann-Whitney U test says the new
+// samples are slower at the given significance and the median slowdown
+// exceeds the threshold.
+class BenchmarkBaseline {
+public:
+    static constexpr int kFormatVersion = 1;
+    
+    // P(current is not slower than baseline), normal approximation with tie
+    // correction and continuity correction.
+    static double mannWhitneySlowerPValue(const std::vector<double>& baseline, const std::vector<double>& current) {
+        std::size_t n1 = baseline.size(), n2 = current.size(), n = n1 + n2;
+        if (n1 == 0 || n2 == 0) {
+            return 1.0;
+        }
+        std::vector<std::pair<double, bool>> pooled;
+        pooled.reserve(n);
+        for (double v : baseline) {
+            pooled.emplace_back(v, false);
+        }
+        for (double v : current) {
+            pooled.emplace_back(v, true);
+        }
+        std::sort(pooled.begin(), pooled.end());
+        
+        double rank_sum = 0.0, tie_term = 0.0;
+        for (std::size_t i = 0; i < n;) {
+            std::size_t j = i;
+            while (j < n && pooled[j].first == pooled[i].first) {
+                ++j;
+            }
+            double rank = 0.5 * (i + 1 + j);
+            for (std::size_t k = i; k < j; ++k) {
+                if (pooled[k].second) {
+                    rank_sum += rank;
+                }
+            }
+            double t = static_cast<double>(j - i);
+            tie_term += t * t * t - t;
+            i = j;
+        }
+        
+        double u = rank_sum - n2 * (n2 + 1) / 2.0;
+        double mean = n1 * n2 / 2.0;
+        double variance = n1 * n2 / 12.0 * ((n + 1) - tie_term / (static_cast<double>(n) * (n - 1)));
+        if (variance <= 0.0) {
+            return 1.0;
+        }
+        double z = (u - mean - 0.5) / std::sqrt(variance);
+        return 0.5 * std::erfc(z / std::sqrt(2.0));
+    }
+    
+    static void save(const std::string& path, const std::vector<BenchmarkSeries>& series) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            throw std::runtime_error("cannot open " + path + ": " + std::strerror(errno));
+        }
+        JsonWriter json(&out);
+        json.beginObject();
+        json.field("version", kFormatVersion);
+        json.field("unit", "ns/op");
+        json.key("benchmarks").beginArray();
+        for (const auto& s : series) {
+            json.beginObject();
+            json.field("name", s.name);
+            json.key("samples").beginArray();
+            for (double v : s.ns_per_op) {
+                json.value(v);
+            }
+            json.endArray();
+            json.endObject();
+        }
+        json.endArray();
+        json.endObject();
+        json.newline();
+        json.flush();
+        if (!out) {
+            throw std::runtime_error("write failed for " + path);
+        }
+    }
+    
+    static std::vector<BenchmarkSeries> load(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error("cannot open " + path + ": " + std::strerror(errno));
+        }
+        std::stringstream text;
+        text << in.rdbuf();
+        JsonValue root = JsonReader::parse(text.str());
+        
+        const JsonValue* version = root.find("version");
+        const JsonValue* benchmarks = root.find("benchmarks");
+        if (!version || version->number != kFormatVersion || !benchmarks ||
+            benchmarks->type != JsonValue::Array) {
+            throw std::runtime_error(path + " is not a version " + std::to_string(kFormatVersion) +
+                                     " benchmark baseline");
+        }
+        std::vector<BenchmarkSeries> series;
+        for (const JsonValue& b : benchmarks->items) {
+            const JsonValue* name = b.find("name");
+            const JsonValue* samples = b.find("samples");
+            if (!name || name->type != JsonValue::String || !samples || samples->type != JsonValue::Array) {
+                throw std::runtime_error(path + ": malformed benchmark entry");
+            }
+            BenchmarkSeries s{name->text, {}};
+            for (const JsonValue& v : samples->items) {
+                s.ns_per_op.push_back(v.number);
+            }
+            series.push_back(std::move(s));
+        }
+        return series;
+    }
+    
+    static BenchmarkComparison compare(const BenchmarkSeries& baseline, const BenchmarkSeries& current,
+                                       double threshold_percent, double significance = 0.01) {
+        BenchmarkComparison c;
+        c.name = current.name;
+        c.baseline_median = baseline.median();
+        c.current_median = current.median();
+        c.change_percent = c.baseline_median > 0.0
+            ? (c.current_median / c.baseline_median - 1.0) * 100.0 : 0.0;
+        c.p_value = mannWhitneySlowerPValue(baseline.ns_per_op, current.ns_per_op);
+        c.regression = c.p_value < significance && c.change_percent > threshold_percent;
+        return c;
+    }
+};
+
+static_assert(sizeof(int) == sizeof(int32_t), "C ABI assumes 32-bit int");
+
+extern "C" {
+
+int pricing_abi_version(void) {
+    return PRICING_ABI_VERSION;
+}
+
+int pricing_optimize_batch(size_t n,
+                           const double* current_price,
+                           const double* cost,
+                           const double* elasticity,
+                           const double* base_demand,
+                           const double* min_competitor,
+                           const double* max_competitor,
+                           const int32_t* inventory_level,
+                           const int32_t* target_inventory,
+                           double* optimal_price,
+                           double* expected_demand,
+                           double* expected_revenue,
+                           double* revenue_lift_percent) {
+    if (n == 0) {
+        return PRICING_OK;
+    }
+    if (!current_price || !cost || !elasticity || !base_demand) {
+        return PRICING_ERROR_NULL_ARGUMENT;
+    }
+    
+    try {
+        PriceOptimizer optimizer;
+        for (size_t i = 0; i < n; ++i) {
+            double current = current_price[i];
+            double e = elasticity[i];
+            double base = base_demand[i];
+            double min_comp = min_competitor ? min_competitor[i] : current * 0.8;
+            double max_comp = max_competitor ? max_competitor[i] : current * 1.2;
+            int inventory = inventory_level ? inventory_level[i] : 0;
+            int target = target_inventory ? target_inventory[i] : 0;
+            
+            OptimizationResult r = optimizer.optimizeWithDemand([=](double price) {
+                return base * std::pow(price / current, e);
+            }, current, cost[i], min_comp, max_comp, inventory, target);
+            
+            if (optimal_price) optimal_price[i] = r.optimal_price;
+            if (expected_demand) expected_demand[i] = r.expected_demand;
+            if (expected_revenue) expected_revenue[i] = r.expected_revenue;
+            if (revenue_lift_percent) revenue_lift_percent[i] = r.revenue_lift_percent;
+        }
+    } catch (...) {
+        return PRICING_ERROR_INTERNAL;
+    }
+    return PRICING_OK;
+}
+
+int pricing_predict_demand_batch(size_t n,
+                                 const double* base_demand,
+                                 const double* elasticity,
+                                 const double* current_price,
+                                 const double* new_price,
+                                 double* demand) {
+    if (n == 0) {
+        return PRICING_OK;
+    }
+    if (!base_demand || !elasticity || !current_price || !new_price || !demand) {
+        return PRICING_ERROR_NULL_ARGUMENT;
+    }
+    
+    for (size_t i = 0; i < n; ++i) {
+        demand[i] = base_demand[i] * std::pow(new_price[i] / current_price[i], elasticity[i]);
+    }
+    return PRICING_OK;
+}
+
+int pricing_fit_elasticity_batch(size_t n,
+                                 const size_t* offsets,
+                                 const double* prices,
+                                 const double* quantities,
+                                 double* elasticity,
+                                 double* base_demand) {
+    if (n == 0) {
+        return PRICING_OK;
+    }
+    if (!offsets || !prices || !quantities) {
+        return PRICING_ERROR_NULL_ARGUMENT;
+    }
+    
+    for (size_t i = 0; i < n; ++i) {
+        size_t first = offsets[i];
+        size_t last = offsets[i + 1];
+        if (last < first) {
+            return PRICING_ERROR_INVALID_ARGUMENT;
+        }
+        size_t count = last - first;
+        if (elasticity) {
+            elasticity[i] = ElasticityCalculator::fitLogLogSlope(prices + first, quantities + first, count);
+        }
+        if (base_demand) {
+            double sum = std::accumulate(quantities + first, quantities + last, 0.0);
+            base_demand[i] = count ? sum / count : 0.0;
+        }
+    }
+    return PRICING_OK;
+}
+
+int pricing_gamma_poisson_fit_batch(size_t n,
+                                    const size_t* offsets,
+                                    const int32_t* purchases,
+                                    double prior_alpha,
+                                    double prior_beta,
+                                    int iterations,
+                                    double* alpha,
+                                    double* beta) {
+    if (n == 0) {
+        return PRICING_OK;
+    }
+    if (!offsets || !purchases || !alpha || !beta) {
+        return PRICING_ERROR_NULL_ARGUMENT;
+    }
+    if (prior_alpha <= 0.0 || prior_beta <= 0.0 || iterations < 0) {
+        return PRICING_ERROR_INVALID_ARGUMENT;
+    }
+    
+    try {
+        for (size_t i = 0; i < n; ++i) {
+            if (offsets[i + 1] < offsets[i]) {
+                return PRICING_ERROR_INVALID_ARGUMENT;
+            }
+            double a = prior_alpha;
+            double b = prior_beta;
+            GammaPoissonModel::fitParameters(purchases + offsets[i], offsets[i + 1] - offsets[i], iterations, a, b);
+            alpha[i] = a;
+            beta[i] = b;
+        }
+    } catch (...) {
+        return PRICING_ERROR_INTERNAL;
+    }
+    return PRICING_OK;
+}
+
+}
+
+#ifndef PRICING_SHARED_LIBRARY
+
+void runDemo() {
     std::cout << "=== Dynamic Pricing Engine - C++ Optimizer ===" << std::endl << std::endl;
     
-    GammaPoissonModel gp_model(2.0, 1.0);
-    std::vector<int> purchase_history = {12, 15, 18, 14, 16, 13, 17, 15, 14, 16};
-    gp_model.fit(purchase_history);
+    GammaPoissonModel gp_model(2.0, 1.0);
+    std::vector<int> purchase_history = {12, 15, 18, 14, 16, 13, 17, 15, 14, 16};
+    gp_model.fit(purchase_history);
+    
+    std::cout << "Gamma-Poisson Model:" << std::endl;
+    std::cout << "  Alpha: " << gp_model.getAlpha() << std::endl;
+    std::cout << "  Beta: " << gp_model.getBeta() << std::endl;
+    std::cout << "  Mean Demand: " << gp_model.getMean() << std::endl;
+    std::cout << "  Variance: " << gp_model.getVariance() << std::endl << std::endl;
+    
+    PriceOptimizer optimizer;
+    std::vector<double> prices = {20, 22, 24, 26, 28, 30, 32, 34, 36, 38, 40};
+    std::vector<double> quantities;
+    for (double p : prices) {
+        quantities.push_back(2000 - 30 * p + (std::rand() % 100 - 50));
+    }
+    
+    std::string product_id = "PROD001";
+    optimizer.trainElasticity(product_id, prices, quantities);
+    
+    std::cout << "Price Elasticity: " << optimizer.getElasticity(product_id) << std::endl << std::endl;
+    
+    std::vector<double> competitor_prices = {33.0, 37.0, 36.5};
+    OptimizationResult result = optimizer.optimizePrice(
+        product_id, 35.0, 20.0, competitor_prices, 450, 400
+    );
+    
+    std::cout << "Price Optimization Results:" << std::endl;
+    std::cout << "  Optimal Price: $" << result.optimal_price << std::endl;
+    std::cout << "  Expected Demand: " << result.expected_demand << std::endl;
+    std::cout << "  Expected Revenue: $" << result.expected_revenue << std::endl;
+    std::cout << "  Revenue Lift: " << result.revenue_lift_percent << "%" << std::endl << std::endl;
+    
+    ProductModelTable model_table;
+    uint32_t product_index = model_table.addProduct(35.0);
+    model_table.assign(product_index, optimizer.getElasticityCalculator(), product_id, gp_model);
+    
+    std::cout << "Compact Model Table:" << std::endl;
+    std::cout << "  Bytes per Product: " << ProductModelTable::bytesPerProduct() << std::endl;
+    std::cout << "  100M Products: " << ProductModelTable::memoryRequired(100000000) / (1024.0 * 1024.0 * 1024.0)
+              << " GiB" << std::endl;
+    std::cout << "  Demand at $" << result.optimal_price << ": "
+              << model_table.predictDemand(product_index, result.optimal_price) << std::endl << std::endl;
+    
+    BayesianOptimizer<1> bayes_opt({{{20.0, 50.0}}});
+    auto objective = [](const BayesianOptimizer<1>::Vector& x) {
+        return -(x[0] - 32.5) * (x[0] - 32.5) + 150.0;
+    };
+    
+    for (int i = 0; i < 15; ++i) {
+        auto x_next = bayes_opt.proposeNext();
+        double y_next = objective(x_next);
+        bayes_opt.update(x_next, y_next);
+    }
+    
+    auto [best_params, best_value] = bayes_opt.getBest();
+    std::cout << "Bayesian Optimization Results:" << std::endl;
+    std::cout << "  Best Price: $" << best_params[0] << std::endl;
+    std::cout << "  Best Objective Value: " << best_value << std::endl;
+}
+
+void printNumaResult(const std::string& label, const NumaBenchmarkResult& r) {
+    std::cout << "  " << label << ":" << std::endl;
+    std::cout << "    Time: " << r.seconds * 1000.0 << " ms" << std::endl;
+    std::cout << "    Throughput: " << r.products_per_second / 1e6 << " M products/s" << std::endl;
+    std::cout << "    Remote Accesses: " << r.remote_accesses << " / " << r.total_accesses << std::endl;
+    std::cout << "    Explicit Huge Pages: " << (r.explicit_huge_pages ? "yes" : "no") << std::endl;
+}
+
+void runNumaBenchmark(std::size_t products) {
+    NumaTopology topology;
+    std::size_t cpus = 0;
+    for (const auto& node : topology.getNodes()) {
+        cpus += node.cpus.size();
+    }
+    
+    std::cout << "=== NUMA Catalog Benchmark ===" << std::endl;
+    std::cout << "  Products: " << products << std::endl;
+    std::cout << "  NUMA Nodes: " << topology.getNodes().size() << ", CPUs: " << cpus << std::endl;
+    
+    NumaCatalogBenchmark bench(topology, products);
+    printNumaResult("Interleaved (4 KB pages, unpinned)", bench.runInterleaved(cpus));
+    printNumaResult("Node-local (huge pages, pinned)", bench.runNodeLocal());
+}
+
+void runSharedModelPublish(const std::string& name, std::size_t products) {
+    ProductModelTable table(products);
+    for (std::size_t i = 0; i < products; ++i) {
+        uint32_t index = table.addProduct(20.0 + static_cast<double>(i % 53));
+        table.setElasticity(index, -1.2 - 0.8 * static_cast<double>(i % 97) / 97.0, 50.0 + i % 31);
+    }
+    
+    SharedModelSegment segment = SharedModelSegment::create(name, products);
+    auto start = std::chrono::steady_clock::now();
+    segment.publishTable(table);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    
+    std::cout << "Published " << segment.size() << " models to shared memory segment " << name
+              << " in " << ms << " ms (generation " << segment.generation() << ")" << std::endl;
+}
+
+void runSharedModelRead(const std::string& name, uint32_t index) {
+    SharedModelSegment segment = SharedModelSegment::open(name);
+    ProductModelRecord r;
+    if (!segment.read(index, r)) {
+        std::cout << "Product " << index << " not published (segment holds " << segment.size() << ")" << std::endl;
+        return;
+    }
+    std::cout << "Product " << index << " (generation " << segment.generation() << "):" << std::endl;
+    std::cout << "  Elasticity: " << r.elasticity << std::endl;
+    std::cout << "  Base Demand: " << r.base_demand << std::endl;
+    std::cout << "  Reference Price: $" << r.reference_price << std::endl;
+    std::cout << "  Demand at +10%: " << segment.predictDemand(index, r.reference_price * 1.1) << std::endl;
+}
+
+void runBayesianResume(const std::string& journal_path, int iterations) {
+    BayesianOptimizer<1> bayes_opt({{{20.0, 50.0}}});
+    std::size_t replayed = bayes_opt.attachJournal(journal_path);
+    auto objective = [](const BayesianOptimizer<1>::Vector& x) {
+        return -(x[0] - 32.5) * (x[0] - 32.5) + 150.0;
+    };
+    
+    for (int i = 0; i < iterations; ++i) {
+        auto x_next = bayes_opt.proposeNext();
+        bayes_opt.update(x_next, objective(x_next));
+    }
+    bayes_opt.syncJournal();
+    
+    auto [best_params, best_value] = bayes_opt.getBest();
+    std::cout << "Bayesian Optimization (journal " << journal_path << "):" << std::endl;
+    std::cout << "  Replayed Observations: " << replayed << std::endl;
+    std::cout << "  Total Observations: " << bayes_opt.size() << std::endl;
+    std::cout << "  Best Price: $" << best_params[0] << std::endl;
+    std::cout << "  Best Objective Value: " << best_value << std::endl;
+}
+
+void runJsonDemo() {
+    GammaPoissonModel gp_model(2.0, 1.0);
+    gp_model.fit({12, 15, 18, 14, 16, 13, 17, 15, 14, 16});
+    
+    PriceOptimizer optimizer;
+    std::vector<double> prices = {20, 22, 24, 26, 28, 30, 32, 34, 36, 38, 40};
+    std::vector<double> quantities;
+    for (double p : prices) {
+        quantities.push_back(2000 - 30 * p + (std::rand() % 100 - 50));
+    }
+    std::string product_id = "PROD001";
+    optimizer.trainElasticity(product_id, prices, quantities);
+    OptimizationResult result = optimizer.optimizePrice(product_id, 35.0, 20.0, {33.0, 37.0, 36.5}, 450, 400);
+    
+    JsonWriter json(&std::cout);
+    json.beginObject();
+    json.key("demand_model");
+    json.writeGammaPoisson(product_id, gp_model);
+    json.key("elasticity");
+    json.writeElasticity(product_id, optimizer.getElasticity(product_id),
+                         optimizer.getElasticityCalculator().getBaseDemand(product_id));
+    json.key("optimization");
+    json.writeResult(product_id, result);
+    json.endObject().newline();
+}
+
+void runJsonBenchmark(std::size_t count) {
+    std::ofstream out("/dev/null", std::ios::binary);
+    JsonWriter json(&out, 1 << 20);
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> price(10.0, 100.0);
+    std::vector<OptimizationResult> results(4096);
+    for (auto& r : results) {
+        r = {price(rng), price(rng) * 10.0, price(rng) * 500.0, price(rng) - 50.0};
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < count; ++i) {
+        json.writeResult("PROD001", results[i & 4095]).newline();
+    }
+    json.flush();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    std::cout << "=== JSON Serialization Benchmark ===" << std::endl;
+    std::cout << "  Results: " << count << std::endl;
+    std::cout << "  Time: " << seconds * 1000.0 << " ms" << std::endl;
+    std::cout << "  Throughput: " << count / seconds / 1e6 << " M results/s" << std::endl;
+}
+
+void writeSampleBatchInput(const std::string& path, std::size_t rows, std::size_t chunk_rows) {
+    ColumnarWriter writer(path, {
+        ColumnSpec::make("current_price", ColumnType::Float64),
+        ColumnSpec::make("cost", ColumnType::Float64),
+        ColumnSpec::make("elasticity", ColumnType::Float64),
+        ColumnSpec::make("base_demand", ColumnType::Float64),
+        ColumnSpec::make("min_competitor", ColumnType::Float64),
+        ColumnSpec::make("max_competitor", ColumnType::Float64),
+        ColumnSpec::make("inventory_level", ColumnType::Int32),
+        ColumnSpec::make("target_inventory", ColumnType::Int32),
+    });
+    
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> price_dist(10.0, 100.0);
+    std::uniform_real_distribution<double> elasticity_dist(-3.0, -1.1);
+    std::uniform_int_distribution<int32_t> inventory_dist(100, 800);
+    std::vector<double> price, cost, elasticity, base, min_comp, max_comp;
+    std::vector<int32_t> inventory, target;
+    
+    for (std::size_t first = 0; first < rows; first += chunk_rows) {
+        std::size_t n = std::min(chunk_rows, rows - first);
+        for (auto* v : {&price, &cost, &elasticity, &base, &min_comp, &max_comp}) {
+            v->resize(n);
+        }
+        inventory.resize(n);
+        target.resize(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            price[i] = price_dist(rng);
+            cost[i] = price[i] * 0.6;
+            elasticity[i] = elasticity_dist(rng);
+            base[i] = 100.0;
+            min_comp[i] = price[i] * 0.9;
+            max_comp[i] = price[i] * 1.15;
+            inventory[i] = inventory_dist(rng);
+            target[i] = 400;
+        }
+        writer.writeChunk(n, {price.data(), cost.data(), elasticity.data(), base.data(),
+                              min_comp.data(), max_comp.data(), inventory.data(), target.data()});
+    }
+    writer.close();
+}
+
+void runColumnarBatch(const std::string& input_path, const std::string& output_path) {
+    ColumnarReader reader(input_path);
+    for (const char* required : {"current_price", "cost", "elasticity", "base_demand"}) {
+        if (reader.columnIndex(required) < 0) {
+            throw std::runtime_error(std::string("input is missing column '") + required + "'");
+        }
+    }
+    
+    ColumnarWriter writer(output_path, {
+        ColumnSpec::make("optimal_price", ColumnType::Float64),
+        ColumnSpec::make("expected_demand", ColumnType::Float64),
+        ColumnSpec::make("expected_revenue", ColumnType::Float64),
+        ColumnSpec::make("revenue_lift_percent", ColumnType::Float64),
+    });
+    std::vector<double> price, demand, revenue, lift;
+    
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t c = 0; c < reader.chunkCount(); ++c) {
+        std::size_t n = reader.chunkRows(c);
+        price.resize(n);
+        demand.resize(n);
+        revenue.resize(n);
+        lift.resize(n);
+        int status = pricing_optimize_batch(n,
+            reader.column<double>(c, "current_price"), reader.column<double>(c, "cost"),
+            reader.column<double>(c, "elasticity"), reader.column<double>(c, "base_demand"),
+            reader.column<double>(c, "min_competitor"), reader.column<double>(c, "max_competitor"),
+            reader.column<int32_t>(c, "inventory_level"), reader.column<int32_t>(c, "target_inventory"),
+            price.data(), demand.data(), revenue.data(), lift.data());
+        if (status != PRICING_OK) {
+            throw std::runtime_error("batch optimization failed with status " + std::to_string(status));
+        }
+        writer.writeChunk(n, {price.data(), demand.data(), revenue.data(), lift.data()});
+    }
+    writer.close();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    std::cout << "Optimized " << reader.totalRows() << " products in " << reader.chunkCount()
+              << " chunks (" << seconds * 1000.0 << " ms, "
+              << reader.totalRows() / seconds / 1e6 << " M products/s)" << std::endl;
+}
+
+void runHistoryBenchmark(std::size_t products, std::size_t observations) {
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int> price_point(0, 11);
+    std::uniform_real_distribution<double> elasticity_dist(-2.5, -0.8);
+    std::vector<std::vector<double>> raw_prices(products), raw_quantities(products);
+    CompressedHistoryStore store;
+    
+    for (std::size_t p = 0; p < products; ++p) {
+        double list_price = 9.99 + static_cast<double>(p % 40);
+        double elasticity = elasticity_dist(rng);
+        auto& prices = raw_prices[p];
+        auto& quantities = raw_quantities[p];
+        prices.reserve(observations);
+        quantities.reserve(observations);
+        for (std::size_t i = 0; i < observations; ++i) {
+            double price = std::round((list_price - 0.5 * price_point(rng)) * 100.0) / 100.0;
+            std::poisson_distribution<int> units(20.0 * std::pow(price / list_price, elasticity));
+            prices.push_back(price);
+            quantities.push_back(units(rng) + 1);
+        }
+        store.addProduct(prices.data(), quantities.data(), observations);
+    }
+    store.shrinkToFit();
+    
+    double checksum_raw = 0.0, checksum_packed = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t p = 0; p < products; ++p) {
+        checksum_raw += ElasticityCalculator::fitLogLogSlope(raw_prices[p].data(), raw_quantities[p].data(),
+                                                             observations);
+    }
+    double raw_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    start = std::chrono::steady_clock::now();
+    for (std::size_t p = 0; p < products; ++p) {
+        checksum_packed += store.fit(static_cast<uint32_t>(p)).elasticity;
+    }
+    double packed_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    std::cout << "=== Price History Compression Benchmark ===" << std::endl;
+    std::cout << "  Products: " << products << ", Observations/Product: " << observations << std::endl;
+    std::cout << "  Raw Histories: " << store.uncompressedBytes() / (1024.0 * 1024.0) << " MiB" << std::endl;
+    std::cout << "  Compressed: " << store.memoryUsage() / (1024.0 * 1024.0) << " MiB ("
+              << static_cast<double>(store.uncompressedBytes()) / store.memoryUsage() << "x)" << std::endl;
+    std::cout << "  Raw Fit: " << products / raw_seconds / 1e3 << " K products/s" << std::endl;
+    std::cout << "  Compressed Fit: " << products / packed_seconds / 1e3 << " K products/s" << std::endl;
+    std::cout << "  Mean Elasticity (raw/compressed): " << checksum_raw / products << " / "
+              << checksum_packed / products << std::endl;
+}
+
+void runSearchBenchmark(std::size_t products) {
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> price_dist(10.0, 100.0);
+    std::uniform_real_distribution<double> elasticity_dist(-4.0, -1.1);
+    std::uniform_real_distribution<double> spread_dist(0.05, 0.4);
+    struct Case { double price, cost, elasticity, min_comp, max_comp; };
+    std::vector<Case> cases(products);
+    for (auto& c : cases) {
+        c.price = price_dist(rng);
+        c.cost = c.price * 0.5;
+        c.elasticity = elasticity_dist(rng);
+        c.min_comp = c.price * (1.0 - spread_dist(rng));
+        c.max_comp = c.price * (1.0 + spread_dist(rng));
+    }
+    
+    auto run = [&](const SearchSettings& settings, std::vector<double>& prices) {
+        PriceOptimizer optimizer;
+        optimizer.setSearchSettings(settings);
+        long long evaluations = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < products; ++i) {
+            const Case& c = cases[i];
+            OptimizationResult r = optimizer.optimizeWithDemand([&](double p) {
+                return 100.0 * std::pow(p / c.price, c.elasticity);
+            }, c.price, c.cost, c.min_comp, c.max_comp, 400, 400);
+            prices[i] = r.optimal_price;
+            evaluations += r.objective_evaluations;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return std::make_pair(static_cast<double>(evaluations) / products, seconds);
+    };
+    
+    SearchSettings golden;
+    golden.method = LineSearchMethod::GoldenSection;
+    std::vector<double> golden_prices(products), brent_prices(products);
+    auto [golden_evals, golden_seconds] = run(golden, golden_prices);
+    auto [brent_evals, brent_seconds] = run(SearchSettings{}, brent_prices);
+    
+    double max_diff = 0.0;
+    for (std::size_t i = 0; i < products; ++i) {
+        max_diff = std::max(max_diff, std::abs(golden_prices[i] - brent_prices[i]));
+    }
+    
+    std::cout << "=== Line Search Benchmark ===" << std::endl;
+    std::cout << "  Products: " << products << std::endl;
+    std::cout << "  Golden Section (1e-5 abs): " << golden_evals << " evals/product, "
+              << products / golden_seconds / 1e6 << " M products/s" << std::endl;
+    std::cout << "  Brent (half-cent): " << brent_evals << " evals/product, "
+              << products / brent_seconds / 1e6 << " M products/s" << std::endl;
+    std::cout << "  Max Price Difference: $" << max_diff << std::endl;
+}
+
+void runWarmStartBenchmark(std::size_t products, int ticks) {
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> price_dist(10.0, 100.0);
+    std::uniform_real_distribution<double> elasticity_dist(-4.0, -1.1);
+    std::normal_distribution<double> drift(0.0, 0.003);
+    struct Product { double price, cost, elasticity, min_comp, max_comp; };
+    std::vector<Product> catalog(products);
+    for (auto& p : catalog) {
+        p.price = price_dist(rng);
+        p.cost = p.price * 0.5;
+        p.elasticity = elasticity_dist(rng);
+        p.min_comp = p.price * 0.85;
+        p.max_comp = p.price * 1.3;
+    }
+    
+    PriceOptimizer optimizer;
+    std::vector<WarmStartState> warm(products);
+    long long cold_evals = 0, warm_evals = 0;
+    double cold_seconds = 0.0, warm_seconds = 0.0, max_diff = 0.0;
+    
+    for (int tick = 0; tick <= ticks; ++tick) {
+        for (auto& p : catalog) {
+            p.cost *= 1.0 + drift(rng);
+            p.min_comp *= 1.0 + drift(rng);
+            p.max_comp *= 1.0 + drift(rng);
+        }
+        
+        auto start = std::chrono::steady_clock::now();
+        std::vector<double> cold_prices(products);
+        for (std::size_t i = 0; i < products; ++i) {
+            const Product& p = catalog[i];
+            OptimizationResult r = optimizer.optimizeWithDemand([&](double x) {
+                return 100.0 * std::pow(x / p.price, p.elasticity);
+            }, p.price, p.cost, p.min_comp, p.max_comp, 400, 400);
+            cold_prices[i] = r.optimal_price;
+            cold_evals += tick > 0 ? r.objective_evaluations : 0;
+        }
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        cold_seconds += tick > 0 ? elapsed : 0.0;
+        
+        start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < products; ++i) {
+            const Product& p = catalog[i];
+            OptimizationResult r = optimizer.optimizeWithDemand([&](double x) {
+                return 100.0 * std::pow(x / p.price, p.elasticity);
+            }, p.price, p.cost, p.min_comp, p.max_comp, 400, 400, &warm[i]);
+            warm_evals += tick > 0 ? r.objective_evaluations : 0;
+            max_diff = std::max(max_diff, std::abs(r.optimal_price - cold_prices[i]));
+        }
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        warm_seconds += tick > 0 ? elapsed : 0.0;
+    }
+    
+    double repricings = static_cast<double>(products) * ticks;
+    std::cout << "=== Warm-Start Repricing Benchmark ===" << std::endl;
+    std::cout << "  Products: " << products << ", Ticks: " << ticks << std::endl;
+    std::cout << "  Cold: " << cold_evals / repricings << " evals/product, "
+              << cold_seconds * 1000.0 / ticks << " ms/tick" << std::endl;
+    std::cout << "  Warm: " << warm_evals / repricings << " evals/product, "
+              << warm_seconds * 1000.0 / ticks << " ms/tick" << std::endl;
+    std::cout << "  Max Price Difference: $" << max_diff << std::endl;
+}
+
+void runIncrementalBenchmark(std::size_t products, double change_rate, int ticks) {
+    std::mt19937 rng(9);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    ProductModelTable models(products);
+    for (std::size_t i = 0; i < products; ++i) {
+        uint32_t index = models.addProduct(10.0 + 90.0 * unit(rng));
+        models.setElasticity(index, -1.1 - 2.9 * unit(rng), 100.0);
+    }
+    
+    IncrementalRepricingEngine engine(models);
+    for (uint32_t i = 0; i < products; ++i) {
+        double price = models[i].reference_price;
+        engine.setProduct(i, price * 0.5, price * 0.85, price * 1.3, 400, 400);
+    }
+    RepricingTickStats initial;
+    engine.tick(&initial);
     
-    std::cout << "Gamma-Poisson Model:" << std::endl;
-    std::cout << "  Alpha: " << gp_model.getAlpha() << std::endl;
-    std::cout << "  Beta: " << gp_model.getBeta() << std::endl;
-    std::cout << "  Mean Demand: " << gp_model.getMean() << std::endl;
-    std::cout << "  Variance: " << gp_model.getVariance() << std::endl << std::endl;
+    PriceOptimizer full;
+    std::size_t changed = static_cast<std::size_t>(products * change_rate);
+    double incremental_seconds = 0.0, full_seconds = 0.0;
+    std::size_t published = 0;
+    std::uniform_int_distribution<uint32_t> pick(0, static_cast<uint32_t>(products - 1));
+    
+    for (int t = 0; t < ticks; ++t) {
+        for (std::size_t c = 0; c < changed; ++c) {
+            uint32_t i = pick(rng);
+            double price = models[i].reference_price;
+            switch (c % 3) {
+                case 0: engine.setCost(i, price * (0.45 + 0.1 * unit(rng))); break;
+                case 1: engine.setCompetitorBounds(i, price * (0.8 + 0.1 * unit(rng)), price * 1.3); break;
+                default: engine.setInventory(i, unit(rng) < 0.5 ? 200 : 600); break;
+            }
+        }
+        RepricingTickStats stats;
+        engine.tick(&stats);
+        incremental_seconds += stats.seconds;
+        published += stats.published;
+        
+        auto start = std::chrono::steady_clock::now();
+        double checksum = 0.0;
+        for (uint32_t i = 0; i < products; ++i) {
+            double price = models[i].reference_price;
+            checksum += full.optimizeModel(models[i], price * 0.5, price * 0.85, price * 1.3, 400, 400).optimal_price;
+        }
+        full_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        volatile double sink = checksum;
+        (void)sink;
+    }
+    
+    std::cout << "=== Incremental Repricing Benchmark ===" << std::endl;
+    std::cout << "  Products: " << products << ", Changes/Tick: " << changed << ", Ticks: " << ticks << std::endl;
+    std::cout << "  Initial Full Pass: " << initial.seconds * 1000.0 << " ms" << std::endl;
+    std::cout << "  Full Reprice: " << full_seconds * 1000.0 / ticks << " ms/tick" << std::endl;
+    std::cout << "  Incremental: " << incremental_seconds * 1000.0 / ticks << " ms/tick" << std::endl;
+    std::cout << "  Published Price Changes: " << static_cast<double>(published) / ticks << "/tick" << std::endl;
+}
+
+void runEventBenchmark(std::size_t products, std::size_t events, std::size_t repricing_budget) {
+    std::mt19937 rng(13);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    ProductModelTable models(products);
+    for (std::size_t i = 0; i < products; ++i) {
+        uint32_t index = models.addProduct(5.0 + 195.0 * unit(rng) * unit(rng));
+        models.setElasticity(index, -1.1 - 2.9 * unit(rng), 10.0 + 990.0 * unit(rng) * unit(rng) * unit(rng));
+    }
+    IncrementalRepricingEngine engine(models);
+    for (uint32_t i = 0; i < products; ++i) {
+        double price = models[i].reference_price;
+        engine.setProduct(i, price * 0.5, price * 0.85, price * 1.3, 400, 400);
+    }
+    engine.tick();
+    
+    std::vector<PricingEvent> stream(events);
+    std::uniform_int_distribution<uint32_t> pick(0, static_cast<uint32_t>(products - 1));
+    for (std::size_t k = 0; k < events; ++k) {
+        uint32_t i = pick(rng);
+        double price = models[i].reference_price;
+        switch (k % 3) {
+            case 0:
+                stream[k] = {PricingEventType::CompetitorChange, i, price * (0.8 + 0.1 * unit(rng)),
+                             price * (1.2 + 0.15 * unit(rng))};
+                break;
+            case 1:
+                stream[k] = {PricingEventType::InventoryChange, i, 150.0 + 500.0 * unit(rng), 0.0};
+                break;
+            default:
+                stream[k] = {PricingEventType::CostChange, i, price * (0.45 + 0.1 * unit(rng)), 0.0};
+                break;
+        }
+    }
+    
+    EventDrivenRepricer repricer(engine);
+    auto start = std::chrono::steady_clock::now();
+    repricer.submit(stream.data(), stream.size());
+    double ingest_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::size_t backlog = repricer.backlog();
+    
+    start = std::chrono::steady_clock::now();
+    std::size_t published = repricer.process(repricing_budget).size();
+    double process_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    std::cout << "=== Event-Driven Repricing Benchmark ===" << std::endl;
+    std::cout << "  Products: " << products << ", Events: " << events << std::endl;
+    std::cout << "  Ingest: " << events / ingest_seconds / 1e6 << " M events/s ("
+              << repricer.eventsApplied() << " applied, " << repricer.eventsIgnored() << " ignored)" << std::endl;
+    std::cout << "  Queue Backlog: " << backlog << std::endl;
+    std::cout << "  Repriced (budget " << repricing_budget << "): " << process_seconds * 1000.0 << " ms, "
+              << published << " price changes" << std::endl;
+}
+
+void runBacktest(std::size_t products, int days, unsigned threads) {
+    std::mt19937 rng(17);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    ProductModelTable models(products);
+    std::vector<double> costs(products);
+    for (std::size_t i = 0; i < products; ++i) {
+        uint32_t index = models.addProduct(10.0 + 90.0 * unit(rng));
+        models.setElasticity(index, -1.1 - 2.4 * unit(rng), 20.0);
+        GammaPoissonModel demand(4.0 + 16.0 * unit(rng), 0.5 + unit(rng));
+        models.setDemandModel(index, demand);
+        costs[i] = models[index].reference_price * (0.4 + 0.2 * unit(rng));
+    }
+    
+    std::vector<BacktestEvent> events;
+    events.reserve(products * days * 3);
+    for (int day = 0; day < days; ++day) {
+        int64_t t = static_cast<int64_t>(day) * 86400;
+        for (uint32_t i = 0; i < products; ++i) {
+            double reference = models[i].reference_price;
+            double price = reference * (0.9 + 0.05 * (day % 5));
+            double mean = models[i].alpha / models[i].beta * std::pow(price / reference, models[i].elasticity);
+            events.push_back({t, i, BacktestEventType::CompetitorPrice, reference * (0.85 + 0.3 * unit(rng)), 0.0});
+            events.push_back({t + 3600, i, BacktestEventType::Inventory, 0.0, 200.0 + 400.0 * unit(rng)});
+            events.push_back({t + 7200, i, BacktestEventType::Sale, price,
+                              static_cast<double>(std::poisson_distribution<int>(mean)(rng))});
+        }
+    }
+    
+    BacktestConfig config;
+    config.threads = threads;
+    BacktestEngine engine(models, costs, config);
+    BacktestReport report = engine.run(events);
+    
+    std::cout << "=== Backtest ===" << std::endl;
+    std::cout << "  Products: " << report.products << ", Events: " << report.events
+              << ", Repricings: " << report.repricings << std::endl;
+    std::cout << "  Realized Revenue: $" << report.realized_revenue
+              << ", Margin: $" << report.realized_margin << std::endl;
+    std::cout << "  Simulated Revenue: $" << report.simulated_revenue
+              << ", Margin: $" << report.simulated_margin << std::endl;
+    std::cout << "  Margin Lift: " << (report.simulated_margin / report.realized_margin - 1.0) * 100.0 << "%"
+              << std::endl;
+    std::cout << "  Replay: " << report.seconds * 1000.0 << " ms, "
+              << report.eventsPerSecond() / 1e6 << " M events/s" << std::endl;
+}
+
+void runPolicySweep(std::size_t products, std::size_t variants, unsigned threads) {
+    std::mt19937 rng(19);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<SweepProduct> catalog(products);
+    for (auto& p : catalog) {
+        p.current_price = 10.0 + 90.0 * unit(rng);
+        p.cost = p.current_price * (0.4 + 0.2 * unit(rng));
+        p.min_comp = p.current_price * (0.8 + 0.15 * unit(rng));
+        p.max_comp = p.current_price * (1.05 + 0.25 * unit(rng));
+        p.inventory_level = static_cast<int>(200 + 400 * unit(rng));
+        p.target_inventory = 400;
+        p.elasticity = -1.1 - 2.4 * unit(rng);
+        p.base_demand = 10.0 + 90.0 * unit(rng);
+    }
+    
+    PolicySweep sweep(catalog);
+    std::vector<PricingPolicy> policies = PolicySweep::randomVariants(PricingPolicy(), variants);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<PolicySweepResult> results = sweep.run(policies, threads);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    double baseline = results.front().profit;
+    std::sort(results.begin(), results.end(), [](const PolicySweepResult& a, const PolicySweepResult& b) {
+        return a.profit > b.profit;
+    });
+    
+    std::cout << "=== Policy Sweep ===" << std::endl;
+    std::cout << "  Products: " << products << ", Variants: " << variants << std::endl;
+    std::cout << "  Time: " << seconds * 1000.0 << " ms ("
+              << products * variants / seconds / 1e6 << " M product-evaluations/s)" << std::endl;
+    std::cout << "  Baseline Profit: $" << baseline << std::endl;
+    for (std::size_t k = 0; k < std::min<std::size_t>(5, results.size()); ++k) {
+        const PricingPolicy& p = policies[results[k].policy];
+        std::cout << "  #" << k + 1 << " variant " << results[k].policy << ": profit $" << results[k].profit
+                  << " (" << (results[k].profit / baseline - 1.0) * 100.0 << "%), inventory "
+                  << p.overstock_threshold << "/" << p.understock_threshold << " x "
+                  << p.overstock_factor << "/" << p.understock_factor << ", bracket "
+                  << p.cost_markup << "/" << p.competitor_floor << "/" << p.current_price_cap << "/"
+                  << p.competitor_ceiling << std::endl;
+    }
+}
+
+void runParetoFrontiers(std::size_t products, int grid_points) {
+    std::mt19937 rng(23);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<SweepProduct> catalog(products);
+    for (auto& p : catalog) {
+        p.current_price = 10.0 + 90.0 * unit(rng);
+        p.cost = p.current_price * (0.4 + 0.2 * unit(rng));
+        p.min_comp = p.current_price * (0.8 + 0.15 * unit(rng));
+        p.max_comp = p.current_price * (1.05 + 0.25 * unit(rng));
+        p.inventory_level = 400;
+        p.target_inventory = 400;
+        p.elasticity = -0.5 - 3.0 * unit(rng);
+        p.base_demand = 10.0 + 90.0 * unit(rng);
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    ParetoFrontierSet frontiers = ParetoFrontierSet::build(catalog, PricingPolicy(), grid_points);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    frontiers.shrinkToFit();
+    
+    std::cout << "=== Pareto Frontiers (profit, units, revenue) ===" << std::endl;
+    std::cout << "  Products: " << products << ", Grid Points: " << grid_points << std::endl;
+    std::cout << "  Time: " << seconds * 1000.0 << " ms (" << products / seconds / 1e6 << " M products/s)" << std::endl;
+    std::cout << "  Mean Frontier Size: " << static_cast<double>(frontiers.pointCount()) / products << std::endl;
+    std::cout << "  Memory: " << frontiers.memoryUsage() / (1024.0 * 1024.0) << " MiB ("
+              << static_cast<double>(frontiers.memoryUsage()) / products << " B/product)" << std::endl;
+    
+    const ParetoPoint* f = frontiers.frontier(0);
+    std::cout << "  Product 0 Frontier:" << std::endl;
+    for (std::size_t i = 0; i < frontiers.frontierSize(0); i += std::max<std::size_t>(1, frontiers.frontierSize(0) / 6)) {
+        std::cout << "    $" << f[i].price << ": profit " << f[i].profit << ", units " << f[i].units
+                  << ", revenue " << f[i].revenue << std::endl;
+    }
+    const ParetoPoint& balanced = frontiers.select(0, 0.5, 0.25, 0.25);
+    std::cout << "  Product 0 Balanced (0.5/0.25/0.25): $" << balanced.price << std::endl;
+}
+
+void runConjugateBenchmark(std::size_t products, int periods) {
+    std::mt19937 rng(29);
+    std::vector<double> rates(products);
+    std::gamma_distribution<double> rate_dist(3.0, 2.0);
+    for (auto& r : rates) {
+        r = rate_dist(rng);
+    }
+    std::vector<std::vector<uint32_t>> counts(periods, std::vector<uint32_t>(products));
+    for (int t = 0; t < periods; ++t) {
+        for (std::size_t i = 0; i < products; ++i) {
+            counts[t][i] = std::poisson_distribution<uint32_t>(rates[i])(rng);
+        }
+    }
+    
+    StreamingGammaPoissonStore store(products, 2.0, 1.0, 0.98);
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < periods; ++t) {
+        store.applyPeriod(counts[t].data());
+    }
+    double streaming_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    std::size_t refit_products = std::min<std::size_t>(products, 10000);
+    std::vector<int> history(periods);
+    start = std::chrono::steady_clock::now();
+    double checksum = 0.0;
+    for (std::size_t i = 0; i < refit_products; ++i) {
+        for (int t = 0; t < periods; ++t) {
+            history[t] = static_cast<int>(counts[t][i]);
+        }
+        double alpha = 2.0, beta = 1.0;
+        GammaPoissonModel::fitParameters(history.data(), history.size(), 1000, alpha, beta);
+        checksum += alpha / beta;
+    }
+    double refit_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    volatile double sink = checksum;
+    (void)sink;
+    
+    double error = 0.0;
+    for (std::size_t i = 0; i < products; ++i) {
+        error += std::abs(store.getMean(static_cast<uint32_t>(i)) - rates[i]) / rates[i];
+    }
+    
+    std::cout << "=== Streaming Gamma-Poisson Benchmark ===" << std::endl;
+    std::cout << "  Products: " << products << ", Periods: " << periods << std::endl;
+    std::cout << "  Streaming Updates: " << products * periods / streaming_seconds / 1e6 << " M updates/s" << std::endl;
+    std::cout << "  Full Refit: " << refit_products / refit_seconds / 1e3 << " K products/s" << std::endl;
+    std::cout << "  Mean Relative Rate Error: " << error / products * 100.0 << "%" << std::endl;
+}
+
+void runTrace(const std::string& path, std::size_t products, unsigned threads) {
+#if PRICING_ENABLE_TRACING
+    TraceRecorder& recorder = TraceRecorder::instance();
+    
+    const int kOverheadSpans = 1000000;
+    recorder.start(kOverheadSpans);
+    double span_ns = 0.0;
+    for (int pass = 0; pass < 2; ++pass) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kOverheadSpans; ++i) {
+            PRICING_TRACE_SCOPE("overhead_probe");
+        }
+        span_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+                  kOverheadSpans;
+    }
+    auto start = std::chrono::steady_clock::now();
+    uint64_t ticks = 0;
+    for (int i = 0; i < kOverheadSpans; ++i) {
+        ticks += TraceRecorder::now();
+    }
+    double clock_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+                      kOverheadSpans;
+    volatile uint64_t sink = ticks;
+    (void)sink;
+    recorder.stop();
+    recorder.clear();
+    
+    std::size_t per_thread_spans = products / std::max(1u, threads) * 8 + 64;
+    recorder.start(per_thread_spans);
+    std::atomic<std::size_t> next{0};
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t]() {
+            std::mt19937 rng(1000 + t);
+            std::normal_distribution<double> noise(0.0, 0.05);
+            std::vector<double> prices(90), quantities(90);
+            std::vector<int> purchases(90);
+            PriceOptimizer optimizer;
+            std::size_t i;
+            while ((i = next.fetch_add(1, std::memory_order_relaxed)) < products) {
+                double base_price = 20.0 + static_cast<double>(i % 200);
+                for (std::size_t d = 0; d < prices.size(); ++d) {
+                    prices[d] = base_price * (0.8 + 0.4 * d / prices.size());
+                    quantities[d] = 500.0 * std::pow(prices[d] / base_price, -1.4) * std::exp(noise(rng));
+                    purchases[d] = static_cast<int>(quantities[d]);
+                }
+                double alpha = 2.0, beta = 1.0;
+                GammaPoissonModel::fitParameters(purchases.data(), purchases.size(), 50, alpha, beta);
+                std::string id = "SKU" + std::to_string(i);
+                optimizer.trainElasticity(id, prices, quantities);
+                optimizer.optimizePrice(id, base_price, base_price * 0.6,
+                                        {base_price * 0.95, base_price * 1.05}, 450, 400);
+            }
+        });
+    }
+    for (auto& worker : pool) {
+        worker.join();
+    }
+    recorder.stop();
+    
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        throw std::runtime_error("cannot open " + path + ": " + std::strerror(errno));
+    }
+    std::size_t spans = 0;
+    for (const TraceRing* ring : recorder.threadRings()) {
+        spans += std::min<std::size_t>(ring->recorded(), ring->capacity());
+    }
+    {
+        JsonWriter json(&out);
+        writeChromeTrace(json, recorder);
+        json.newline();
+    }
+    
+    std::cout << "=== Trace Capture ===" << std::endl;
+    std::cout << "  Products: " << products << ", Threads: " << threads << std::endl;
+    std::cout << "  Spans Written: " << spans << std::endl;
+    std::cout << "  Span Overhead: " << span_ns << " ns (timestamp read: " << clock_ns << " ns)" << std::endl;
+    std::cout << "  Output: " << path << " (open in chrome://tracing or ui.perfetto.dev)" << std::endl;
+#else
+    (void)path;
+    (void)products;
+    (void)threads;
+    throw std::runtime_error("built with PRICING_ENABLE_TRACING=0");
+#endif
+}
+
+void runPerfCounters(std::size_t products) {
+    std::mt19937 rng(17);
+    std::uniform_real_distribution<double> price_dist(10.0, 100.0);
+    std::uniform_real_distribution<double> elasticity_dist(-4.0, -1.1);
+    std::normal_distribution<double> noise(0.0, 0.05);
+    const std::size_t kObservations = 90;
+    
+    std::vector<double> prices(products), elasticities(products);
+    std::vector<double> history_prices(products * kObservations), history_quantities(products * kObservations);
+    std::vector<int> purchases(products * kObservations);
+    ProductModelTable table(products);
+    for (std::size_t i = 0; i < products; ++i) {
+        prices[i] = price_dist(rng);
+        elasticities[i] = elasticity_dist(rng);
+        for (std::size_t d = 0; d < kObservations; ++d) {
+            double p = prices[i] * (0.8 + 0.4 * d / kObservations);
+            double q = 100.0 * std::pow(p / prices[i], elasticities[i]) * std::exp(noise(rng));
+            history_prices[i * kObservations + d] = p;
+            history_quantities[i * kObservations + d] = q;
+            purchases[i * kObservations + d] = static_cast<int>(q);
+        }
+        uint32_t idx = table.addProduct(prices[i]);
+        table.setElasticity(idx, elasticities[i], 100.0);
+    }
+    std::vector<uint32_t> order(products);
+    std::iota(order.begin(), order.end(), 0u);
+    std::shuffle(order.begin(), order.end(), rng);
+    
+    PerfCounterGroup counters;
+    std::cout << "=== Hardware Counter Report ===" << std::endl;
+    std::cout << "  Products: " << products << std::endl;
+    if (!counters.available()) {
+        std::cout << "  Counters unavailable (" << counters.lastError()
+                  << "); reporting wall time only" << std::endl;
+    }
+    
+    double checksum = 0.0;
+    auto measure = [&](const char* kernel, auto body) {
+        counters.start();
+        body();
+        PerfSample s = counters.stop();
+        std::cout << "  " << kernel << ": " << s.seconds / products * 1e9 << " ns/product";
+        if (s.has(PerfCounter::Cycles) && s.has(PerfCounter::Instructions)) {
+            std::cout << ", IPC " << s.ipc()
+                      << ", " << static_cast<double>(s.value(PerfCounter::Cycles)) / products << " cycles/product";
+        }
+        if (s.has(PerfCounter::LlcMisses)) {
+            std::cout << ", " << static_cast<double>(s.value(PerfCounter::LlcMisses)) / products << " LLC misses/product";
+        }
+        if (s.has(PerfCounter::Branches) && s.has(PerfCounter::BranchMisses)) {
+            std::cout << ", " << s.branchMissRate() * 100.0 << "% branch misses";
+        }
+        std::cout << std::endl;
+    };
+    
+    auto search = [&](LineSearchMethod method) {
+        PriceOptimizer optimizer;
+        SearchSettings settings;
+        settings.method = method;
+        optimizer.setSearchSettings(settings);
+        for (std::size_t i = 0; i < products; ++i) {
+            double price = prices[i], elasticity = elasticities[i];
+            checksum += optimizer.optimizeWithDemand([=](double p) {
+                return 100.0 * std::pow(p / price, elasticity);
+            }, price, price * 0.5, price * 0.9, price * 1.1, 400, 400).optimal_price;
+        }
+    };
+    measure("goldenSectionSearch", [&]() { search(LineSearchMethod::GoldenSection); });
+    measure("brentSearch", [&]() { search(LineSearchMethod::Brent); });
+    measure("logRegression", [&]() {
+        for (std::size_t i = 0; i < products; ++i) {
+            checksum += ElasticityCalculator::fitLogLogSlope(history_prices.data() + i * kObservations,
+                                                             history_quantities.data() + i * kObservations,
+                                                             kObservations);
+        }
+    });
+    measure("gammaPoissonFit", [&]() {
+        for (std::size_t i = 0; i < products; ++i) {
+            double alpha = 2.0, beta = 1.0;
+            GammaPoissonModel::fitParameters(purchases.data() + i * kObservations, kObservations, 50, alpha, beta);
+            checksum += alpha / beta;
+        }
+    });
+    measure("predictDemand (random order)", [&]() {
+        for (uint32_t idx : order) {
+            checksum += table.predictDemand(idx, prices[idx] * 1.05);
+        }
+    });
+    volatile double sink = checksum;
+    (void)sink;
+}
+
+std::vector<BenchmarkSeries> runBenchmarkSuite(int samples) {
+    const std::size_t kCatalog = 256;
+    const std::size_t kTableProducts = 1 << 20;
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> price_dist(10.0, 100.0);
+    std::uniform_real_distribution<double> elasticity_dist(-3.0, -1.1);
     
     PriceOptimizer optimizer;
-    std::vector<double> prices = {20, 22, 24, 26, 28, 30, 32, 34, 36, 38, 40};
-    std::vector<double> quantities;
-    for (double p : prices) {
-        quantities.push_back(2000 - 30 * p + (std::rand() % 100 - 50));
+    optimizer.setWarmStart(false);
+    std::vector<std::string> ids(kCatalog);
+    std::vector<double> catalog_prices(kCatalog);
+    std::vector<double> history_prices(30), history_quantities(30);
+    for (std::size_t i = 0; i < kCatalog; ++i) {
+        ids[i] = "SKU" + std::to_string(i);
+        catalog_prices[i] = price_dist(rng);
+        double elasticity = elasticity_dist(rng);
+        for (std::size_t d = 0; d < history_prices.size(); ++d) {
+            history_prices[d] = catalog_prices[i] * (0.8 + 0.4 * d / history_prices.size());
+            history_quantities[d] = 200.0 * std::pow(history_prices[d] / catalog_prices[i], elasticity);
+        }
+        optimizer.trainElasticity(ids[i], history_prices, history_quantities);
     }
     
-    std::string product_id = "PROD001";
-    optimizer.trainElasticity(product_id, prices, quantities);
+    ProductModelTable table(kTableProducts);
+    for (std::size_t i = 0; i < kTableProducts; ++i) {
+        uint32_t idx = table.addProduct(price_dist(rng));
+        table.setElasticity(idx, elasticity_dist(rng), 100.0);
+    }
+    std::vector<uint32_t> order(kTableProducts);
+    std::iota(order.begin(), order.end(), 0u);
+    std::shuffle(order.begin(), order.end(), rng);
     
-    std::cout << "Price Elasticity: " << optimizer.getElasticity(product_id) << std::endl << std::endl;
+    BayesianOptimizer<1> bayes({{{20.0, 50.0}}});
+    for (int i = 0; i < 50; ++i) {
+        auto x = bayes.proposeNext();
+        bayes.update(x, -(x[0] - 35.0) * (x[0] - 35.0));
+    }
     
-    std::vector<double> competitor_prices = {33.0, 37.0, 36.5};
-    OptimizationResult result = optimizer.optimizePrice(
-        product_id, 35.0, 20.0, competitor_prices, 450, 400
-    );
+    double checksum = 0.0;
+    auto sample = [&](std::size_t ops, auto body) {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / ops;
+    };
+    auto optimize_pass = [&]() {
+        for (std::size_t i = 0; i < kCatalog * 8; ++i) {
+            std::size_t p = i % kCatalog;
+            double price = catalog_prices[p];
+            checksum += optimizer.optimizePrice(ids[p], price, price * 0.6,
+                                                {price * 0.95, price * 1.05}, 450, 400).optimal_price;
+        }
+    };
+    auto predict_pass = [&]() {
+        for (uint32_t idx : order) {
+            checksum += table.predictDemand(idx, 30.0);
+        }
+    };
+    auto propose_pass = [&]() {
+        for (int i = 0; i < 200; ++i) {
+            checksum += bayes.proposeNext()[0];
+        }
+    };
     
-    std::cout << "Price Optimization Results:" << std::endl;
-    std::cout << "  Optimal Price: $" << result.optimal_price << std::endl;
-    std::cout << "  Expected Demand: " << result.expected_demand << std::endl;
-    std::cout << "  Expected Revenue: $" << result.expected_revenue << std::endl;
-    std::cout << "  Revenue Lift: " << result.revenue_lift_percent << "%" << std::endl << std::endl;
+    std::vector<BenchmarkSeries> series = {{"optimizePrice", {}}, {"predictDemand", {}}, {"proposeNext", {}}};
+    for (int s = -1; s < samples; ++s) {
+        double optimize_ns = sample(kCatalog * 8, optimize_pass);
+        double predict_ns = sample(kTableProducts, predict_pass);
+        double propose_ns = sample(200, propose_pass);
+        if (s >= 0) {
+            series[0].ns_per_op.push_back(optimize_ns);
+            series[1].ns_per_op.push_back(predict_ns);
+            series[2].ns_per_op.push_back(propose_ns);
+        }
+    }
+    volatile double sink = checksum;
+    (void)sink;
+    return series;
+}
+
+int runBenchmarkBaseline(const std::string& action, const std::string& path, double threshold_percent, int samples) {
+    if (action == "save") {
+        std::vector<BenchmarkSeries> current = runBenchmarkSuite(samples);
+        BenchmarkBaseline::save(path, current);
+        std::cout << "=== Benchmark Baseline Saved ===" << std::endl;
+        for (const auto& s : current) {
+            std::cout << "  " << s.name << ": " << s.median() << " ns/op (median of "
+                      << s.ns_per_op.size() << ")" << std::endl;
+        }
+        std::cout << "  Output: " << path << std::endl;
+        return 0;
+    }
     
-    BayesianOptimizer bayes_opt({{20.0, 50.0}});
-    auto objective = [](const std::vector<double>& x) {
-        return -(x[0] - 32.5) * (x[0] - 32.5) + 150.0;
+    std::vector<BenchmarkSeries> baseline = BenchmarkBaseline::load(path);
+    std::vector<BenchmarkSeries> current = runBenchmarkSuite(samples);
+    std::cout << "=== Benchmark Comparison ===" << std::endl;
+    std::cout << "  Baseline: " << path << ", Threshold: " << threshold_percent << "%" << std::endl;
+    int regressions = 0;
+    for (const auto& s : current) {
+        auto it = std::find_if(baseline.begin(), baseline.end(),
+                               [&](const BenchmarkSeries& b) { return b.name == s.name; });
+        if (it == baseline.end()) {
+            std::cout << "  " << s.name << ": not in baseline" << std::endl;
+            continue;
+        }
+        BenchmarkComparison c = BenchmarkBaseline::compare(*it, s, threshold_percent);
+        std::cout << "  " << c.name << ": " << c.baseline_median << " -> " << c.current_median << " ns/op ("
+                  << (c.change_percent >= 0.0 ? "+" : "") << c.change_percent << "%, p=" << c.p_value << ")"
+                  << (c.regression ? " REGRESSION" : "") << std::endl;
+        regressions += c.regression;
+    }
+    std::cout << "  Regressions: " << regressions << std::endl;
+    return regressions ? 2 : 0;
+}
+
+void runSyntheticGenerate(const std::string& catalog_path, const std::string& events_path,
+                          std::size_t products, int days, uint64_t seed) {
+    SyntheticCatalogConfig config;
+    config.seed = seed;
+    config.days = days;
+    SyntheticCatalogGenerator generator(config);
+    
+    auto start = std::chrono::steady_clock::now();
+    generator.writeCatalog(catalog_path, products);
+    double catalog_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    start = std::chrono::steady_clock::now();
+    EventLogWriter log(events_path);
+    for (std::size_t i = 0; i < products; ++i) {
+        generator.events(static_cast<uint32_t>(i), [&](const BacktestEvent& e) { log.append(e); });
+    }
+    log.close();
+    double event_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    std::cout << "=== Synthetic Catalog ===" << std::endl;
+    std::cout << "  Seed: " << seed << ", Products: " << products << ", Days: " << days << std::endl;
+    std::cout << "  Catalog: " << catalog_path << " (" << products / catalog_seconds / 1e6 << " M products/s)"
+              << std::endl;
+    std::cout << "  Events: " << events_path << ", " << log.size() << " events ("
+              << log.size() / event_seconds / 1e6 << " M events/s)" << std::endl;
+}
+
+void runSyntheticBacktest(const std::string& catalog_path, const std::string& events_path, unsigned threads) {
+    ColumnarReader catalog(catalog_path);
+    for (const char* required : {"current_price", "cost", "elasticity", "base_demand"}) {
+        if (catalog.columnIndex(required) < 0) {
+            throw std::runtime_error(std::string("catalog is missing column '") + required + "'");
+        }
+    }
+    bool has_prior = catalog.columnIndex("demand_alpha") >= 0 && catalog.columnIndex("demand_beta") >= 0;
+    ProductModelTable models(catalog.totalRows());
+    std::vector<double> costs;
+    costs.reserve(catalog.totalRows());
+    for (std::size_t c = 0; c < catalog.chunkCount(); ++c) {
+        const double* price = catalog.column<double>(c, "current_price");
+        const double* cost = catalog.column<double>(c, "cost");
+        const double* elasticity = catalog.column<double>(c, "elasticity");
+        const double* base = catalog.column<double>(c, "base_demand");
+        const double* alpha = has_prior ? catalog.column<double>(c, "demand_alpha") : nullptr;
+        const double* beta = has_prior ? catalog.column<double>(c, "demand_beta") : nullptr;
+        for (std::size_t i = 0; i < catalog.chunkRows(c); ++i) {
+            uint32_t index = models.addProduct(price[i]);
+            models.setElasticity(index, elasticity[i], base[i]);
+            if (has_prior) {
+                models.setDemandModel(index, GammaPoissonModel(alpha[i], beta[i]));
+            }
+            costs.push_back(cost[i]);
+        }
+    }
+    
+    std::vector<BacktestEvent> events = EventLogReader::readAll(events_path);
+    
+    BacktestConfig config;
+    config.threads = threads;
+    BacktestEngine engine(models, costs, config);
+    BacktestReport report = engine.run(events);
+    
+    std::cout << "=== Backtest (" << events_path << ") ===" << std::endl;
+    std::cout << "  Products: " << report.products << ", Events: " << report.events
+              << ", Repricings: " << report.repricings << std::endl;
+    if (report.rejected_events > 0) {
+        std::cout << "  Rejected Events: " << report.rejected_events << " (product outside the catalog)" << std::endl;
+    }
+    std::cout << "  Realized Margin: $" << report.realized_margin
+              << ", Simulated Margin: $" << report.simulated_margin << std::endl;
+    std::cout << "  Replay: " << report.seconds * 1000.0 << " ms, "
+              << report.eventsPerSecond() / 1e6 << " M events/s" << std::endl;
+}
+
+void runDeadlineBenchmark(std::size_t products, double budget_ms) {
+    SyntheticCatalogGenerator generator;
+    std::vector<SweepProduct> catalog(products);
+    for (std::size_t i = 0; i < products; ++i) {
+        SyntheticProduct p = generator.product(i);
+        catalog[i] = {p.reference_price, p.cost, p.reference_price * (1.0 - p.competitor_spread),
+                      p.reference_price * (1.0 + p.competitor_spread), p.inventory_level, p.target_inventory,
+                      p.elasticity, p.alpha / p.beta};
+    }
+    
+    std::vector<DeadlinePriceResult> reference(products), bounded(products);
+    DeadlineBatchScheduler unbounded_scheduler;
+    auto far = std::chrono::steady_clock::now() + std::chrono::hours(24);
+    DeadlineBatchReport full = unbounded_scheduler.run(catalog.data(), products, far, reference.data());
+    
+    DeadlineBatchScheduler scheduler;
+    auto budget = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::duration<double, std::milli>(budget_ms));
+    DeadlineBatchReport report = scheduler.run(catalog.data(), products,
+                                               std::chrono::steady_clock::now() + budget, bounded.data());
+    
+    double max_diff = 0.0, sum_diff = 0.0, sum_tolerance = 0.0;
+    for (std::size_t i = 0; i < products; ++i) {
+        double diff = std::abs(bounded[i].price - reference[i].price);
+        max_diff = std::max(max_diff, diff);
+        sum_diff += diff;
+        sum_tolerance += bounded[i].price_tolerance;
+    }
+    
+    BayesianOptimizer<1> bayes({{{20.0, 50.0}}});
+    for (int i = 0; i < 20000; ++i) {
+        double x = 20.0 + 30.0 * i / 20000.0;
+        bayes.update({{x}}, -(x - 35.0) * (x - 35.0));
+    }
+    auto start = std::chrono::steady_clock::now();
+    SearchDeadline checkout = SearchDeadline::after(std::chrono::milliseconds(2));
+    auto proposal = bayes.proposeWithin(checkout);
+    double proposal_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    
+    std::cout << "=== Deadline-Bounded Batch ===" << std::endl;
+    std::cout << "  Products: " << products << ", Full Precision: " << full.seconds * 1000.0 << " ms" << std::endl;
+    std::cout << "  Budget: " << budget_ms << " ms, Elapsed: " << report.seconds * 1000.0 << " ms ("
+              << (report.deadline_met ? "met" : "missed") << ")" << std::endl;
+    std::cout << "  Precision Levels:";
+    for (std::size_t count : report.per_level) {
+        std::cout << " " << count;
+    }
+    std::cout << ", Fallbacks: " << report.fallbacks << std::endl;
+    std::cout << "  Price Error vs Full: mean $" << sum_diff / products << ", max $" << max_diff << std::endl;
+    std::cout << "  Mean Reported Tolerance: $" << sum_tolerance / products << std::endl;
+    std::cout << "  proposeNext (20000 observations, 2 ms budget): " << proposal.candidates << "/"
+              << BayesianOptimizer<1>::kCandidates << " candidates in " << proposal_ms << " ms" << std::endl;
+}
+
+void runAdmissionBenchmark(double seconds, double checkout_rate, double flood_rate, unsigned workers) {
+    const std::size_t kProducts = 100000;
+    SyntheticCatalogGenerator generator;
+    std::vector<SweepProduct> catalog(kProducts);
+    for (std::size_t i = 0; i < kProducts; ++i) {
+        SyntheticProduct p = generator.product(i);
+        catalog[i] = {p.reference_price, p.cost, p.reference_price * (1.0 - p.competitor_spread),
+                      p.reference_price * (1.0 + p.competitor_spread), p.inventory_level, p.target_inventory,
+                      p.elasticity, p.alpha / p.beta};
+    }
+    
+    auto simulate = [&](bool admission_control) {
+        std::mutex latency_mutex;
+        std::vector<double> checkout_latency;
+        uint64_t checkout_cached = 0;
+        AdmissionConfig config;
+        config.workers = workers;
+        config.enabled = admission_control;
+        config.lanes[0].max_concurrency = workers;
+        config.lanes[1].max_concurrency = std::max(1u, workers - 1);
+        
+        PricingServer server(catalog, [&](const PricingResponse& r) {
+            if (r.lane != RequestLane::Checkout) {
+                return;
+            }
+            double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - r.enqueued).count();
+            std::lock_guard<std::mutex> lock(latency_mutex);
+            checkout_latency.push_back(us);
+            checkout_cached += r.source == ResponseSource::Cached;
+        }, config);
+        
+        // Open-loop load in 1 ms ticks; the batch flood covers the middle half
+        // of the run.
+        std::mt19937 rng(23);
+        std::uniform_int_distribution<uint32_t> product(0, kProducts - 1);
+        auto start = std::chrono::steady_clock::now();
+        int ticks = static_cast<int>(seconds * 1000.0);
+        double checkout_due = 0.0, flood_due = 0.0;
+        for (int t = 0; t < ticks; ++t) {
+            checkout_due += checkout_rate / 1000.0;
+            if (t >= ticks / 4 && t < ticks * 3 / 4) {
+                flood_due += flood_rate / 1000.0;
+            }
+            for (; flood_due >= 1.0; flood_due -= 1.0) {
+                server.submit(product(rng), RequestLane::Batch);
+            }
+            for (; checkout_due >= 1.0; checkout_due -= 1.0) {
+                server.submit(product(rng), RequestLane::Checkout);
+            }
+            std::this_thread::sleep_until(start + std::chrono::milliseconds(t + 1));
+        }
+        server.stop();
+        
+        std::sort(checkout_latency.begin(), checkout_latency.end());
+        auto percentile = [&](double q) {
+            return checkout_latency.empty() ? 0.0
+                : checkout_latency[static_cast<std::size_t>(q * (checkout_latency.size() - 1))];
+        };
+        AdmissionLaneStats checkout = server.laneStats(RequestLane::Checkout);
+        AdmissionLaneStats batch = server.laneStats(RequestLane::Batch);
+        
+        std::cout << "  " << (admission_control ? "Admission Control" : "Unbounded FIFO") << ":" << std::endl;
+        std::cout << "    Checkout p50/p99/max: " << percentile(0.5) << " / " << percentile(0.99) << " / "
+                  << percentile(1.0) << " us, Served From Cache: " << checkout_cached << std::endl;
+        std::cout << "    Checkout Completed: " << checkout.completed << ", Shed: " << checkout.shed()
+                  << ", Deadline Cut: " << checkout.deadline_cut << std::endl;
+        std::cout << "    Batch Completed: " << batch.completed << ", Shed (full/predicted/expired): "
+                  << batch.shed_queue_full << "/" << batch.shed_predicted << "/" << batch.shed_expired << std::endl;
+        if (admission_control) {
+            JsonWriter json;
+            server.writeStats(json);
+            std::cout << "    Stats: " << json.str() << std::endl;
+        }
     };
     
-    for (int i = 0; i < 15; ++i) {
-        std::vector<double> x_next = bayes_opt.proposeNext();
-        double y_next = objective(x_next);
-        bayes_opt.update(x_next, y_next);
+    std::cout << "=== Admission Control Simulation ===" << std::endl;
+    std::cout << "  Duration: " << seconds << " s, Checkout: " << checkout_rate << "/s, Batch Flood: "
+              << flood_rate << "/s, Workers: " << workers << std::endl;
+    simulate(false);
+    simulate(true);
+}
+
+void runElasticityContentionBenchmark(unsigned threads, std::size_t products, std::size_t ops_per_thread) {
+    std::vector<std::string> ids(products);
+    for (std::size_t i = 0; i < products; ++i) {
+        ids[i] = "SKU" + std::to_string(i);
     }
+    const std::vector<double> prices = {20.0, 22.0, 24.0, 26.0, 28.0, 30.0, 32.0, 34.0};
     
-    auto [best_params, best_value] = bayes_opt.getBest();
-    std::cout << "Bayesian Optimization Results:" << std::endl;
-    std::cout << "  Best Price: $" << best_params[0] << std::endl;
-    std::cout << "  Best Objective Value: " << best_value << std::endl;
+    // The straightforward fix: one mutex around the original std::map layout.
+    struct GlobalLockCalculator {
+        std::mutex mutex;
+        std::map<std::string, ElasticityEntry> models;
+        
+        void calculateElasticity(const std::vector<double>& p, const std::vector<double>& q, const std::string& id) {
+            double elasticity = ElasticityCalculator::fitLogLogSlope(p.data(), q.data(), p.size());
+            double base = std::accumulate(q.begin(), q.end(), 0.0) / q.size();
+            std::lock_guard<std::mutex> lock(mutex);
+            models[id] = {elasticity, base};
+        }
+        
+        double predictDemand(double current_price, double new_price, const std::string& id) {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = models.find(id);
+            return it == models.end() ? 0.0
+                : it->second.base_demand * std::pow(new_price / current_price, it->second.elasticity);
+        }
+    };
+    
+    auto run = [&](auto& calculator) {
+        std::vector<std::thread> pool;
+        std::atomic<bool> go{false};
+        std::atomic<uint64_t> checksum_bits{0};
+        for (unsigned t = 0; t < threads; ++t) {
+            pool.emplace_back([&, t]() {
+                std::mt19937_64 rng(t + 1);
+                std::vector<double> quantities(prices.size());
+                double checksum = 0.0;
+                while (!go.load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+                }
+                for (std::size_t i = 0; i < ops_per_thread; ++i) {
+                    uint64_t r = rng();
+                    const std::string& id = ids[r % products];
+                    if ((r >> 32) % 10 == 0) {
+                        double elasticity = -1.0 - static_cast<double>((r >> 40) & 0xff) / 128.0;
+                        for (std::size_t d = 0; d < prices.size(); ++d) {
+                            quantities[d] = 100.0 * std::pow(prices[d] / 20.0, elasticity);
+                        }
+                        calculator.calculateElasticity(prices, quantities, id);
+                    } else {
+                        checksum += calculator.predictDemand(25.0, 27.5, id);
+                    }
+                }
+                checksum_bits.fetch_add(static_cast<uint64_t>(checksum), std::memory_order_relaxed);
+            });
+        }
+        auto start = std::chrono::steady_clock::now();
+        go.store(true, std::memory_order_release);
+        for (auto& worker : pool) {
+            worker.join();
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+    
+    GlobalLockCalculator global;
+    ElasticityCalculator sharded;
+    double global_seconds = run(global);
+    double sharded_seconds = run(sharded);
+    double total_ops = static_cast<double>(threads) * ops_per_thread;
+    
+    std::cout << "=== Elasticity Store Contention ===" << std::endl;
+    std::cout << "  Threads: " << threads << ", Products: " << products
+              << ", Mix: 90% predictDemand / 10% train" << std::endl;
+    std::cout << "  Global Lock std::map: " << total_ops / global_seconds / 1e6 << " M ops/s" << std::endl;
+    std::cout << "  Sharded Store: " << total_ops / sharded_seconds / 1e6 << " M ops/s ("
+              << sharded.size() << " products trained)" << std::endl;
+}
+
+void runIngestBenchmark(unsigned producers, std::size_t events_per_producer, std::size_t products) {
+    StreamingGammaPoissonStore store(products, 2.0, 1.0);
+    PurchaseEventIngestor ingestor(store, producers);
+    const int kPeriods = 10;
+    const uint64_t total_events = static_cast<uint64_t>(producers) * events_per_producer;
+    
+    std::atomic<unsigned> finished{0};
+    std::atomic<uint64_t> pushed_quantity{0};
+    std::atomic<uint64_t> backoffs{0};
+    std::vector<std::thread> pool;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned t = 0; t < producers; ++t) {
+        pool.emplace_back([&, t]() {
+            PurchaseEventIngestor::Producer& producer = ingestor.producer(t);
+            uint64_t x = 0x9e3779b97f4a7c15ULL * (t + 1);
+            uint64_t quantity_sum = 0, waits = 0;
+            for (std::size_t i = 0; i < events_per_producer; ++i) {
+                x ^= x << 13;
+                x ^= x >> 7;
+                x ^= x << 17;
+                uint32_t product = static_cast<uint32_t>(x % products);
+                uint32_t quantity = 1 + static_cast<uint32_t>((x >> 32) % 3);
+                while (!producer.tryPush(product, quantity)) {
+                    ++waits;
+                    std::this_thread::yield();
+                }
+                quantity_sum += quantity;
+            }
+            pushed_quantity.fetch_add(quantity_sum, std::memory_order_relaxed);
+            backoffs.fetch_add(waits, std::memory_order_relaxed);
+            finished.fetch_add(1, std::memory_order_release);
+        });
+    }
+    
+    std::thread consumer([&]() {
+        uint64_t next_period = total_events / kPeriods;
+        for (;;) {
+            bool done = finished.load(std::memory_order_acquire) == producers;
+            std::size_t n = ingestor.drain();
+            if (ingestor.eventsDrained() >= next_period && ingestor.periodsClosed() + 1 < kPeriods) {
+                ingestor.closePeriod();
+                next_period += total_events / kPeriods;
+            }
+            if (n == 0) {
+                if (done) {
+                    break;
+                }
+                std::this_thread::yield();
+            }
+        }
+        ingestor.closePeriod();
+    });
+    for (auto& worker : pool) {
+        worker.join();
+    }
+    consumer.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    double alpha_gain = 0.0;
+    for (std::size_t i = 0; i < products; ++i) {
+        alpha_gain += store.getAlpha(static_cast<uint32_t>(i)) - 2.0;
+    }
+    uint64_t rejected = 0;
+    for (unsigned t = 0; t < producers; ++t) {
+        rejected += ingestor.producer(t).rejectedCount();
+    }
     
+    std::cout << "=== Purchase Event Ingestion ===" << std::endl;
+    std::cout << "  Producers: " << producers << ", Events: " << ingestor.eventsDrained()
+              << ", Products: " << products << ", Periods: " << ingestor.periodsClosed() << std::endl;
+    std::cout << "  Throughput: " << ingestor.eventsDrained() / seconds / 1e6 << " M events/s" << std::endl;
+    std::cout << "  Back-pressure Rejections: " << rejected << std::endl;
+    std::cout << "  Purchases Applied: " << static_cast<uint64_t>(std::llround(alpha_gain)) << " of "
+              << pushed_quantity.load() << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    
+    if (!args.empty() && args[0] == "--bench-numa") {
+        std::size_t products = args.size() > 1 ? std::stoull(args[1]) : 10000000;
+        runNumaBenchmark(products);
+        return 0;
+    }
+    
+    if (args.size() >= 2 && args[0] == "--shm-publish") {
+        std::size_t products = args.size() > 2 ? std::stoull(args[2]) : 1000000;
+        try {
+            runSharedModelPublish(args[1], products);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    
+    if (args.size() >= 3 && args[0] == "--shm-read") {
+        try {
+            runSharedModelRead(args[1], static_cast<uint32_t>(std::stoul(args[2])));
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    
+    if (args.size() >= 2 && args[0] == "--bayes-resume") {
+        int iterations = args.size() > 2 ? std::stoi(args[2]) : 15;
+        try {
+            runBayesianResume(args[1], iterations);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    
+    if (!args.empty() && args[0] == "--json") {
+        runJsonDemo();
+        return 0;
+    }
+    
+    if (!args.empty() && args[0] == "--bench-json") {
+        runJsonBenchmark(args.size() > 1 ? std::stoull(args[1]) : 2000000);
+        return 0;
+    }
+    
+    if (args.size() >= 2 && args[0] == "--batch-sample") {
+        std::size_t rows = args.size() > 2 ? std::stoull(args[2]) : 1000000;
+        try {
+            writeSampleBatchInput(args[1], rows, 65536);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    
+    if (args.size() >= 3 && args[0] == "--batch") {
+        try {
+            runColumnarBatch(args[1], args[2]);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    
+    if (!args.empty() && args[0] == "--bench-history") {
+        std::size_t products = args.size() > 1 ? std::stoull(args[1]) : 100000;
+        std::size_t observations = args.size() > 2 ? std::stoull(args[2]) : 365;
+        runHistoryBenchmark(products, observations);
+        return 0;
+    }
+    
+    if (!args.empty() && args[0] == "--bench-search") {
+        runSearchBenchmark(args.size() > 1 ? std::stoull(args[1]) : 1000000);
+        return 0;
+    }
+    
+    if (!args.empty() && args[0] == "--bench-warm") {
+        std::size_t products = args.size() > 1 ? std::stoull(args[1]) : 100000;
+        int ticks = args.size() > 2 ? std::stoi(args[2]) : 10;
+        runWarmStartBenchmark(products, ticks);
+        return 0;
+    }
+    
+    if (!args.empty() && args[0] == "--bench-incremental") {
+        std::size_t products = args.size() > 1 ? std::stoull(args[1]) : 1000000;
+        double change_rate = args.size() > 2 ? std::stod(args[2]) : 0.05;
+        int ticks = args.size() > 3 ? std::stoi(args[3]) : 5;
+        runIncrementalBenchmark(products, change_rate, ticks);
+        return 0;
+    }
+    
+    if (!args.empty() && args[0] == "--bench-events") {
+        std::size_t products = args.size() > 1 ? std::stoull(args[1]) : 1000000;
+        std::size_t events = args.size() > 2 ? std::stoull(args[2]) : 5000000;
+        std::size_t budget = args.size() > 3 ? std::stoull(args[3]) : 50000;
+        runEventBenchmark(products, events, budget);
+        return 0;
+    }
+    
+    if (!args.empty() && args[0] == "--backtest") {
+        std::size_t products = args.size() > 1 ? std::stoull(args[1]) : 100000;
+        int days = args.size() > 2 ? std::stoi(args[2]) : 30;
+        unsigned threads = args.size() > 3 ? static_cast<unsigned>(std::stoul(args[3])) : 0;
+        runBacktest(products, days, threads);
+        return 0;
+    }
+    
+    if (!args.empty() && args[0] == "--sweep") {
+        std::size_t products = args.size() > 1 ? std::stoull(args[1]) : 10000;
+        std::size_t variants = args.size() > 2 ? std::stoull(args[2]) : 1000;
+        unsigned threads = args.size() > 3 ? static_cast<unsigned>(std::stoul(args[3])) : 0;
+        runPolicySweep(products, variants, threads);
+        return 0;
+    }
+    
+    if (!args.empty() && args[0] == "--pareto") {
+        std::size_t products = args.size() > 1 ? std::stoull(args[1]) : 1000000;
+        int grid_points = args.size() > 2 ? std::stoi(args[2]) : 32;
+        runParetoFrontiers(products, grid_points);
+        return 0;
+    }
+    
+    if (!args.empty() && args[0] == "--bench-conjugate") {
+        std::size_t products = args.size() > 1 ? std::stoull(args[1]) : 1000000;
+        int periods = args.size() > 2 ? std::stoi(args[2]) : 30;
+        runConjugateBenchmark(products, periods);
+        return 0;
+    }
+    
+    if (!args.empty() && args[0] == "--trace") {
+        std::string path = args.size() > 1 ? args[1] : "pricing_trace.json";
+        std::size_t products = args.size() > 2 ? std::stoull(args[2]) : 10000;
+        unsigned threads = args.size() > 3 ? static_cast<unsigned>(std::stoul(args[3]))
+                                           : std::max(1u, std::thread::hardware_concurrency());
+        try {
+            runTrace(path, products, threads);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    
+    if (!args.empty() && args[0] == "--perf") {
+        std::size_t products = args.size() > 1 ? std::stoull(args[1]) : 100000;
+        runPerfCounters(products);
+        return 0;
+    }
+    
+    if (!args.empty() && (args[0] == "--bench-save" || args[0] == "--bench-compare")) {
+        bool save = args[0] == "--bench-save";
+        std::string path = args.size() > 1 ? args[1] : "bench_baseline.json";
+        double threshold = !save && args.size() > 2 ? std::stod(args[2]) : 5.0;
+        std::size_t samples_arg = save ? 2 : 3;
+        int samples = args.size() > samples_arg ? std::stoi(args[samples_arg]) : 15;
+        try {
+            return runBenchmarkBaseline(save ? "save" : "compare", path, threshold, samples);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+    
+    if (args.size() >= 3 && args[0] == "--generate") {
+        std::size_t products = args.size() > 3 ? std::stoull(args[3]) : 1000000;
+        int days = args.size() > 4 ? std::stoi(args[4]) : 30;
+        uint64_t seed = args.size() > 5 ? std::stoull(args[5]) : 42;
+        try {
+            runSyntheticGenerate(args[1], args[2], products, days, seed);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    
+    if (args.size() >= 3 && args[0] == "--backtest-replay") {
+        unsigned threads = args.size() > 3 ? static_cast<unsigned>(std::stoul(args[3])) : 0;
+        try {
+            runSyntheticBacktest(args[1], args[2], threads);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    
+    if (!args.empty() && args[0] == "--bench-deadline") {
+        std::size_t products = args.size() > 1 ? std::stoull(args[1]) : 100000;
+        double budget_ms = args.size() > 2 ? std::stod(args[2]) : 20.0;
+        runDeadlineBenchmark(products, budget_ms);
+        return 0;
+    }
+    
+    if (!args.empty() && args[0] == "--bench-admission") {
+        double seconds = args.size() > 1 ? std::stod(args[1]) : 2.0;
+        double checkout_rate = args.size() > 2 ? std::stod(args[2]) : 2000.0;
+        double flood_rate = args.size() > 3 ? std::stod(args[3]) : 2000000.0;
+        unsigned workers = args.size() > 4 ? static_cast<unsigned>(std::stoul(args[4])) : 2;
+        runAdmissionBenchmark(seconds, checkout_rate, flood_rate, workers);
+        return 0;
+    }
+    
+    if (!args.empty() && args[0] == "--bench-elasticity-store") {
+        unsigned threads = args.size() > 1 ? static_cast<unsigned>(std::stoul(args[1])) : 64;
+        std::size_t products = args.size() > 2 ? std::stoull(args[2]) : 100000;
+        std::size_t ops = args.size() > 3 ? std::stoull(args[3]) : 100000;
+        runElasticityContentionBenchmark(threads, products, ops);
+        return 0;
+    }
+    
+    if (!args.empty() && args[0] == "--bench-ingest") {
+        unsigned producers = args.size() > 1 ? static_cast<unsigned>(std::stoul(args[1])) : 8;
+        std::size_t events = args.size() > 2 ? std::stoull(args[2]) : 2000000;
+        std::size_t products = args.size() > 3 ? std::stoull(args[3]) : 100000;
+        runIngestBenchmark(producers, events, products);
+        return 0;
+    }
+    
+    runDemo();
     return 0;
-}
\ No newline at end of file
+}
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef PRICE_OPTIMIZER_H
+#define PRICE_OPTIMIZER_H
+
+/*
+ * Stable C ABI for the C++ price optimizer.
+ *
+ * Build as a shared library:
+ *   g++ -std=c++17 -O3 -pthread -fPIC -shared -fvisibility=hidden \
+ *       -DPRICING_SHARED_LIBRARY price_optimizer.cpp -o libprice_optimizer.so
+ *
+ * All batch functions operate on caller-owned contiguous arrays (for example
+ * NumPy buffers passed through ctypes) and write results in place. Nothing is
+ * copied, allocated for the caller, or retained after the call returns.
+ * Optional inputs and outputs may be NULL.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PRICING_ABI_VERSION 1
+
+#if defined(__GNUC__)
+#define PRICING_API __attribute__((visibility("default")))
+#else
+#define PRICING_API
+#endif
+
+enum PricingStatus {
+    PRICING_OK = 0,
+    PRICING_ERROR_NULL_ARGUMENT = -1,
+    PRICING_ERROR_INVALID_ARGUMENT = -2,
+    PRICING_ERROR_INTERNAL = -3
+};
+
+PRICING_API int pricing_abi_version(void);
+
+/*
+ * Optimizes n products with constant-elasticity demand
+ * demand(p) = base_demand * (p / current_price) ^ elasticity.
+ * min_competitor/max_competitor default to 0.8x/1.2x current_price when NULL.
+ */
+PRICING_API int pricing_optimize_batch(size_t n,
+                                       const double* current_price,
+                                       const double* cost,
+                                       const double* elasticity,
+                                       const double* base_demand,
+                                       const double* min_competitor,
+                                       const double* max_competitor,
+                                       const int32_t* inventory_level,
+                                       const int32_t* target_inventory,
+                                       double* optimal_price,
+                                       double* expected_demand,
+                                       double* expected_revenue,
+                                       double* revenue_lift_percent);
+
+PRICING_API int pricing_predict_demand_batch(size_t n,
+                                             const double* base_demand,
+                                             const double* elasticity,
+                                             const double* current_price,
+                                             const double* new_price,
+                                             double* demand);
+
+/*
+ * Fits log-log elasticity for n products whose histories are stored back to
+ * back; product i owns observations [offsets[i], offsets[i + 1]).
+ */
+PRICING_API int pricing_fit_elasticity_batch(size_t n,
+                                             const size_t* offsets,
+                                             const double* prices,
+                                             const double* quantities,
+                                             double* elasticity,
+                                             double* base_demand);
+
+PRICING_API int pricing_gamma_poisson_fit_batch(size_t n,
+                                                const size_t* offsets,
+                                                const int32_t* purchases,
+                                                double prior_alpha,
+                                                double prior_beta,
+                                                int iterations,
+                                                double* alpha,
+                                                double* beta);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif